@@ -0,0 +1,116 @@
+// 比较表驱动和直接编码两种生成的分析器在相同符号流上的速度
+// 两个头文件由 backend --export-cpp 在构建时根据 expr.grammar 生成（见CMakeLists.txt）
+#include "expr_table.h"
+#include "expr_direct.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 随机生成表达式，符号追加到tokens
+static void randomExpr(mt19937& rng, int depth, vector<string>& tokens) {
+    auto operand = [&]() {
+        switch (depth > 0 ? rng() % 5 : rng() % 2) {
+            case 0: tokens.push_back("id"); break;
+            case 1: tokens.push_back("num"); break;
+            case 2:
+                tokens.push_back("(");
+                randomExpr(rng, depth - 1, tokens);
+                tokens.push_back(")");
+                break;
+            case 3:
+                tokens.push_back("id");
+                tokens.push_back("(");
+                randomExpr(rng, depth - 1, tokens);
+                tokens.push_back(")");
+                break;
+            default:
+                tokens.push_back("-");
+                tokens.push_back("num");
+                break;
+        }
+    };
+    static const char* const ops[] = { "+", "-", "*", "/" };
+    operand();
+    for (int n = rng() % 4; n > 0; n--) {
+        tokens.push_back(ops[rng() % 4]);
+        operand();
+    }
+}
+
+// 生成约count个符号的语句序列
+static vector<string> randomProgram(unsigned seed, size_t count) {
+    mt19937 rng(seed);
+    vector<string> tokens;
+    while (tokens.size() < count) {
+        tokens.push_back("id");
+        tokens.push_back("=");
+        randomExpr(rng, 4, tokens);
+        tokens.push_back(";");
+    }
+    return tokens;
+}
+
+template <typename Parse>
+static double bestMillis(int rounds, Parse&& parse) {
+    double best = 1e300;
+    for (int r = 0; r < rounds; r++) {
+        auto start = chrono::steady_clock::now();
+        parse();
+        auto end = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, milli>(end - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? stoul(argv[1]) : 2000000;
+    int rounds = argc > 2 ? stoi(argv[2]) : 10;
+
+    vector<string> tokens = randomProgram(1, count);
+    // 两个分析器的终结符ID相同，预先转换好，只测量分析循环本身
+    vector<int> ids;
+    for (const auto& token : tokens) ids.push_back(expr_table::terminalId(token));
+
+    // 一份合法的符号流，一份在中间出错的符号流（在某个 "id =" 之后再放一个 "="）
+    vector<int> broken = ids;
+    int assign = expr_table::terminalId("=");
+    size_t mid = broken.size() / 2;
+    while (mid + 2 < broken.size() && broken[mid] != assign) mid++;
+    broken[mid + 1] = assign;
+
+    printf("%zu tokens, best of %d rounds\n", ids.size(), rounds);
+    int failures = 0;
+    for (const vector<int>* stream : { &ids, &broken }) {
+        expr_table::Result tableResult;
+        expr_direct::Result directResult;
+        double tableMs = bestMillis(rounds, [&]() {
+            size_t pos = 0;
+            tableResult = expr_table::parseTokens([&]() {
+                return pos < stream->size() ? (*stream)[pos++] : expr_table::END_MARKER;
+            });
+        });
+        double directMs = bestMillis(rounds, [&]() {
+            size_t pos = 0;
+            directResult = expr_direct::parseTokens([&]() {
+                return pos < stream->size() ? (*stream)[pos++] : expr_direct::END_MARKER;
+            });
+        });
+
+        bool same = tableResult.accepted == directResult.accepted &&
+                    tableResult.errorPosition == directResult.errorPosition &&
+                    tableResult.steps == directResult.steps;
+        if (!same) failures++;
+        // 出错时只消耗了出错位置之前的符号
+        double consumed = tableResult.accepted ? stream->size() : tableResult.errorPosition;
+        printf("%-8s accepted=%d steps=%d  table %8.2f ms (%6.1f Mtok/s)  direct %8.2f ms (%6.1f Mtok/s)  speedup %.2fx%s\n",
+               stream == &ids ? "valid" : "broken", tableResult.accepted, tableResult.steps,
+               tableMs, consumed / tableMs / 1000, directMs, consumed / directMs / 1000,
+               tableMs / directMs, same ? "" : "  RESULT MISMATCH");
+    }
+    return failures == 0 ? 0 : 1;
+}
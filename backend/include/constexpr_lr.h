@@ -0,0 +1,700 @@
+// 编译期LR分析表：把文法写成字符串字面量，在编译期构造LR(0)/SLR(1)分析表
+// 文法格式与 /api/load_grammar 相同（每行一项）。闭包、可空性、FIRST/FOLLOW和digraph直接使用
+// 与运行时共用的 lr_algorithms.h；文法文本解析、自动机和分析表的构造依赖数据表示
+// （C++17的常量求值中不能动态分配，这里用定长数组和位图代替运行时的vector与哈希表），因此单独实现，
+// 但与 main.cpp 逐步对应：按符号名次求后继、按编号顺序处理状态、按项目顺序填写规约动作。
+// 符号编号、状态编号和表项都与运行时构造的分析表相同（见 tests/constexpr_lr_test.cpp），冲突的处理也相同：
+//   LR(0)：规约动作覆盖该行已有的动作；SLR(1)：移进-规约冲突保留移进，规约-规约冲突报错（编译错误）
+// 按规则解决的冲突数记录在分析表的conflicts中，可用 static_assert(tables.conflicts == 0) 要求无冲突
+//
+// 用法：
+//   struct Expr {
+//       static constexpr std::string_view text = R"(
+//   NonTerminals: E, T, F
+//   Terminals: +, *, (, ), id
+//   StartSymbol: E
+//   Productions:
+//   E -> E + T | T
+//   T -> T * F | F
+//   F -> ( E ) | id
+//   )";
+//   };
+//   constexpr auto tables = constexpr_lr::slr1Tables<Expr>();
+//   auto result = tables.parse("id + id * id");
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "lr_algorithms.h"
+
+namespace constexpr_lr {
+
+// ACTION表项的打包方式与运行时相同：高2位为动作类型，低30位为目标（状态号或产生式号）
+enum ActionKind : std::uint32_t {
+    ACTION_ERROR = 0,
+    ACTION_SHIFT = 1,
+    ACTION_REDUCE = 2,
+    ACTION_ACCEPT = 3
+};
+
+constexpr std::uint32_t makeAction(ActionKind kind, int target = 0) {
+    return (static_cast<std::uint32_t>(kind) << 30) | static_cast<std::uint32_t>(target);
+}
+
+constexpr ActionKind actionKind(std::uint32_t action) {
+    return static_cast<ActionKind>(action >> 30);
+}
+
+constexpr int actionTarget(std::uint32_t action) {
+    return static_cast<int>(action & 0x3FFFFFFFu);
+}
+
+// 符号名：直接引用文法文本中的字符；增广开始符号的名字是开始符号加 '，用primed表示
+struct Name {
+    std::string_view base;
+    bool primed = false;
+
+    constexpr std::size_t size() const { return base.size() + (primed ? 1 : 0); }
+    constexpr unsigned char operator[](std::size_t i) const {
+        return static_cast<unsigned char>(i < base.size() ? base[i] : '\'');
+    }
+};
+
+// 与 std::string 的比较一致（按unsigned char逐字节比较）
+constexpr bool operator<(const Name& a, const Name& b) {
+    for (std::size_t i = 0; i < a.size() && i < b.size(); i++) {
+        if (a[i] != b[i]) return a[i] < b[i];
+    }
+    return a.size() < b.size();
+}
+
+constexpr bool operator==(const Name& a, const Name& b) {
+    return !(a < b) && !(b < a);
+}
+
+// 位图集合（按项目编号或终结符ID索引）
+template <int Bits>
+struct BitSet {
+    std::array<std::uint64_t, (Bits + 63) / 64> words{};
+
+    constexpr void set(int i) { words[i >> 6] |= (std::uint64_t(1) << (i & 63)); }
+    constexpr bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+    constexpr void unionWith(const BitSet& other) {
+        for (std::size_t w = 0; w < words.size(); w++) words[w] |= other.words[w];
+    }
+
+    constexpr bool operator==(const BitSet& other) const {
+        for (std::size_t w = 0; w < words.size(); w++) {
+            if (words[w] != other.words[w]) return false;
+        }
+        return true;
+    }
+};
+
+// 文法：符号先终结符后非终结符，各自按名字有序；产生式0为增广产生式 S' -> S
+// 项目 (p, dot) 编号为 itemStart[p] + dot，编号顺序即运行时 Item 键的顺序
+template <int NumSymbols, int NumTerminals, int NumProductions, int NumRightSymbols>
+struct Grammar {
+    static constexpr int numSymbols = NumSymbols;
+    static constexpr int numTerminals = NumTerminals;
+    static constexpr int numNonTerminals = NumSymbols - NumTerminals;
+    static constexpr int numProductions = NumProductions;
+    static constexpr int numRightSymbols = NumRightSymbols;
+    static constexpr int numItems = NumRightSymbols + NumProductions;
+
+    std::array<Name, NumSymbols> names{};
+    std::array<int, NumProductions> left{};
+    std::array<int, NumProductions + 1> rightStart{};   // 产生式p的右部为 right[rightStart[p], rightStart[p+1])
+    std::array<int, NumRightSymbols> right{};
+    std::array<int, NumProductions + 1> itemStart{};
+    std::array<int, numItems> itemProduction{};
+    std::array<int, NumSymbols> symbolsByName{};        // 全部符号按名字排序
+    int startSymbol = 0;
+    int endMarker = 0;
+    int augmentedStartSymbol = 0;
+    int augmentedProductionIndex = 0;
+
+    constexpr bool isTerminal(int symbol) const { return symbol < NumTerminals; }
+    constexpr int length(int prodIndex) const { return rightStart[prodIndex + 1] - rightStart[prodIndex]; }
+
+    // 项目点后的符号，点在末尾时为-1
+    constexpr int symbolAfterDot(int item) const {
+        int prodIndex = itemProduction[item];
+        int dot = item - itemStart[prodIndex];
+        return dot < length(prodIndex) ? right[rightStart[prodIndex] + dot] : -1;
+    }
+};
+
+// LR(0)自动机：核心项目集和按 状态 × 符号 存储的转移（-1表示没有转移）
+template <int NumStates, int NumSymbols, int NumItems>
+struct Automaton {
+    static constexpr int capacity = NumStates;
+    int numStates = 0;
+    std::array<BitSet<NumItems>, NumStates> kernels{};
+    std::array<int, NumStates * NumSymbols> transitions{};
+};
+
+// 识别结果，与 ParserBase::RecognizeResult 含义相同
+struct Result {
+    bool accepted = false;
+    int errorPosition = -1;   // 出错时所在输入符号的下标，接受时为-1
+    int steps = 0;
+};
+
+// 分析表：查询接口与 ParserBase 相同，也可交给 ParserBase::recognizeWith 使用
+template <int NumStates, int NumTerminals, int NumNonTerminals, int NumProductions>
+struct Tables {
+    static constexpr int numStates = NumStates;
+    static constexpr int numTerminals = NumTerminals;
+    static constexpr int numNonTerminals = NumNonTerminals;
+    static constexpr int numProductions = NumProductions;
+
+    std::array<std::uint32_t, NumStates * NumTerminals> actionTable{};
+    std::array<int, NumStates * NumNonTerminals> gotoTable{};
+    std::array<int, NumProductions> productionLengths{};
+    std::array<int, NumProductions> productionLefts{};
+    std::array<std::string_view, NumTerminals> terminalNames{};   // 按名字有序，下标即终结符ID
+    int endMarker = 0;
+    int conflicts = 0;   // 按规则解决的冲突表项数（LR(0)：被规约覆盖的表项；SLR(1)：保留移进的表项）
+
+    constexpr std::uint32_t action(int state, int terminal) const {
+        return actionTable[static_cast<std::size_t>(state) * NumTerminals + terminal];
+    }
+    constexpr int gotoState(int state, int nonTerminal) const {
+        return gotoTable[static_cast<std::size_t>(state) * NumNonTerminals + (nonTerminal - NumTerminals)];
+    }
+    constexpr int productionLength(int prodIndex) const { return productionLengths[prodIndex]; }
+    constexpr int productionLeft(int prodIndex) const { return productionLefts[prodIndex]; }
+    constexpr int endMarkerId() const { return endMarker; }
+
+    // 终结符名字到ID，未知符号返回-1
+    constexpr int terminalId(std::string_view name) const {
+        int lo = 0, hi = NumTerminals;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (terminalNames[mid] < name) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < NumTerminals && terminalNames[lo] == name ? lo : -1;
+    }
+
+    // 分析循环：nextToken() 返回下一个终结符ID，输入结束时返回endMarker，未知符号返回-1
+    template <typename NextToken>
+    Result parseTokens(NextToken&& nextToken) const {
+        Result result;
+        std::vector<int> stateStack;
+        stateStack.reserve(64);
+        stateStack.push_back(0);
+        int tokenIndex = 0;
+        int currentToken = nextToken();
+        while (true) {
+            result.steps++;
+            std::uint32_t act = currentToken >= 0 ? action(stateStack.back(), currentToken) : makeAction(ACTION_ERROR);
+            if (actionKind(act) == ACTION_SHIFT) {
+                stateStack.push_back(actionTarget(act));
+                currentToken = nextToken();
+                tokenIndex++;
+            }
+            else if (actionKind(act) == ACTION_REDUCE) {
+                int prodIndex = actionTarget(act);
+                stateStack.resize(stateStack.size() - productionLengths[prodIndex]);
+                int next = gotoState(stateStack.back(), productionLefts[prodIndex]);
+                if (next < 0) break;
+                stateStack.push_back(next);
+            }
+            else if (actionKind(act) == ACTION_ACCEPT) {
+                result.accepted = true;
+                return result;
+            }
+            else {
+                break;
+            }
+        }
+        result.errorPosition = tokenIndex;
+        return result;
+    }
+
+    // 分析输入串：与 ParserBase::parse 相同，按空格切分并去掉符号两端的制表符
+    Result parse(std::string_view input) const {
+        std::size_t pos = 0;
+        return parseTokens([&]() -> int {
+            while (true) {
+                while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\t')) pos++;
+                if (pos == input.size()) return endMarker;
+                std::size_t start = pos;
+                while (pos < input.size() && input[pos] != ' ') pos++;
+                std::size_t end = pos;
+                while (end > start && input[end - 1] == '\t') end--;
+                if (end > start) return terminalId(input.substr(start, end - start));
+            }
+        });
+    }
+};
+
+namespace detail {
+
+constexpr bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// 去掉首尾的空格和制表符（与运行时 Grammar::split 相同）
+constexpr std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// 按分隔符切分，对每个去掉首尾空白后非空的部分调用f（与运行时 Grammar::split 相同）
+template <typename F>
+constexpr void forEachPart(std::string_view s, char delimiter, F&& f) {
+    while (true) {
+        std::size_t end = s.find(delimiter);
+        std::string_view part = trim(s.substr(0, end));
+        if (!part.empty()) f(part);
+        if (end == std::string_view::npos) return;
+        s.remove_prefix(end + 1);
+    }
+}
+
+// 去掉全部空白后是否与name相同（运行时删除产生式左部中的所有空白字符）
+constexpr bool equalsIgnoringSpace(std::string_view text, const Name& name) {
+    std::size_t j = 0;
+    for (char c : text) {
+        if (isSpace(c)) continue;
+        if (j >= name.size() || name[j] != static_cast<unsigned char>(c)) return false;
+        j++;
+    }
+    return j == name.size();
+}
+
+template <std::size_t Capacity>
+constexpr void insertName(std::array<Name, Capacity>& names, int& count, const Name& name) {
+    for (int i = 0; i < count; i++) {
+        if (names[i] == name) return;
+    }
+    names[count++] = name;
+}
+
+template <typename T, std::size_t Capacity, typename Less>
+constexpr void insertionSort(std::array<T, Capacity>& values, int count, Less less) {
+    for (int i = 1; i < count; i++) {
+        T value = values[i];
+        int j = i;
+        while (j > 0 && less(value, values[j - 1])) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+}
+
+// 第一遍：解析文法文本，得到有序的符号名和尚未驻留的产生式；文本长度是各数量的上界
+template <std::size_t N>
+struct ParsedText {
+    std::array<Name, N + 2> terminals{};
+    int numTerminals = 0;
+    std::array<Name, N + 2> nonTerminals{};
+    int numNonTerminals = 0;
+    std::string_view startName{};
+    std::array<std::string_view, N + 1> lefts{};
+    std::array<int, N + 2> rightStart{};
+    std::array<std::string_view, N + 1> rights{};
+    int numProductions = 0;
+    int numRightSymbols = 0;
+};
+
+template <std::size_t N>
+constexpr ParsedText<N> parseText(std::string_view text) {
+    ParsedText<N> parsed;
+    bool parsingProductions = false;
+
+    auto handleLine = [&](std::string_view line) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+        if (line.find("NonTerminals:") != std::string_view::npos) {
+            forEachPart(line.substr(line.find(':') + 1), ',', [&](std::string_view part) {
+                insertName(parsed.nonTerminals, parsed.numNonTerminals, Name{ part });
+            });
+        }
+        else if (line.find("Terminals:") != std::string_view::npos) {
+            // ε不是真正的终结符
+            forEachPart(line.substr(line.find(':') + 1), ',', [&](std::string_view part) {
+                if (part != "ε") insertName(parsed.terminals, parsed.numTerminals, Name{ part });
+            });
+        }
+        else if (line.find("StartSymbol:") != std::string_view::npos) {
+            bool first = true;
+            forEachPart(line.substr(line.find(':') + 1), ' ', [&](std::string_view part) {
+                if (first) parsed.startName = part;
+                first = false;
+            });
+        }
+        else if (line.find("Productions:") != std::string_view::npos) {
+            parsingProductions = true;
+        }
+        else if (parsingProductions && !line.empty()) {
+            std::size_t arrowPos = line.find("->");
+            if (arrowPos == std::string_view::npos) return;
+            std::string_view leftText = line.substr(0, arrowPos);
+
+            // 每个候选式一个产生式，右部遇到ε时为空
+            forEachPart(line.substr(arrowPos + 2), '|', [&](std::string_view alternative) {
+                int start = parsed.numRightSymbols;
+                bool epsilon = false;
+                forEachPart(alternative, ' ', [&](std::string_view symbol) {
+                    if (epsilon) return;
+                    if (symbol == "ε") {
+                        parsed.numRightSymbols = start;
+                        epsilon = true;
+                        return;
+                    }
+                    parsed.rights[parsed.numRightSymbols++] = symbol;
+                });
+                parsed.lefts[parsed.numProductions] = leftText;
+                parsed.rightStart[parsed.numProductions] = start;
+                parsed.numProductions++;
+                parsed.rightStart[parsed.numProductions] = parsed.numRightSymbols;
+            });
+        }
+    };
+    std::string_view rest = text;
+    while (true) {
+        std::size_t end = rest.find('\n');
+        handleLine(rest.substr(0, end));
+        if (end == std::string_view::npos) break;
+        rest.remove_prefix(end + 1);
+    }
+
+    bool startDeclared = false;
+    for (int i = 0; i < parsed.numNonTerminals; i++) {
+        if (parsed.nonTerminals[i] == Name{ parsed.startName }) startDeclared = true;
+    }
+    if (!startDeclared) {
+        throw std::logic_error("Start symbol is not a declared nonterminal");
+    }
+
+    // 文法扩展：添加S'和结束符#
+    insertName(parsed.nonTerminals, parsed.numNonTerminals, Name{ parsed.startName, true });
+    insertName(parsed.terminals, parsed.numTerminals, Name{ "#" });
+    for (int t = 0; t < parsed.numTerminals; t++) {
+        for (int nt = 0; nt < parsed.numNonTerminals; nt++) {
+            if (parsed.terminals[t] == parsed.nonTerminals[nt]) {
+                throw std::logic_error("Symbol is declared as both terminal and nonterminal");
+            }
+        }
+    }
+
+    auto less = [](const Name& a, const Name& b) { return a < b; };
+    insertionSort(parsed.terminals, parsed.numTerminals, less);
+    insertionSort(parsed.nonTerminals, parsed.numNonTerminals, less);
+    return parsed;
+}
+
+// 第二遍：驻留符号，把产生式转换为符号ID
+template <int NumSymbols, int NumTerminals, int NumProductions, int NumRightSymbols, std::size_t N>
+constexpr Grammar<NumSymbols, NumTerminals, NumProductions, NumRightSymbols> intern(const ParsedText<N>& parsed) {
+    Grammar<NumSymbols, NumTerminals, NumProductions, NumRightSymbols> grammar;
+    for (int t = 0; t < NumTerminals; t++) grammar.names[t] = parsed.terminals[t];
+    for (int nt = 0; nt < NumSymbols - NumTerminals; nt++) grammar.names[NumTerminals + nt] = parsed.nonTerminals[nt];
+
+    auto find = [&](const Name& name) {
+        for (int id = 0; id < NumSymbols; id++) {
+            if (grammar.names[id] == name) return id;
+        }
+        return -1;
+    };
+    grammar.startSymbol = find(Name{ parsed.startName });
+    grammar.endMarker = find(Name{ "#" });
+    grammar.augmentedStartSymbol = find(Name{ parsed.startName, true });
+
+    // 增广产生式 S' -> S
+    grammar.augmentedProductionIndex = 0;
+    grammar.left[0] = grammar.augmentedStartSymbol;
+    grammar.rightStart[0] = 0;
+    grammar.right[0] = grammar.startSymbol;
+    int numRight = 1;
+
+    for (int p = 0; p < parsed.numProductions; p++) {
+        int leftId = -1;
+        for (int id = 0; id < NumSymbols; id++) {
+            if (equalsIgnoringSpace(parsed.lefts[p], grammar.names[id])) leftId = id;
+        }
+        if (leftId < 0) {
+            throw std::logic_error("Undeclared symbol in productions");
+        }
+        if (grammar.isTerminal(leftId)) {
+            throw std::logic_error("Terminal cannot be the left side of a production");
+        }
+        grammar.left[p + 1] = leftId;
+        grammar.rightStart[p + 1] = numRight;
+        for (int k = parsed.rightStart[p]; k < parsed.rightStart[p + 1]; k++) {
+            int id = find(Name{ parsed.rights[k] });
+            if (id < 0) {
+                throw std::logic_error("Undeclared symbol in productions");
+            }
+            grammar.right[numRight++] = id;
+        }
+    }
+    grammar.rightStart[NumProductions] = numRight;
+
+    int item = 0;
+    for (int p = 0; p < NumProductions; p++) {
+        grammar.itemStart[p] = item;
+        for (int dot = 0; dot <= grammar.length(p); dot++) grammar.itemProduction[item++] = p;
+    }
+    grammar.itemStart[NumProductions] = item;
+
+    for (int id = 0; id < NumSymbols; id++) grammar.symbolsByName[id] = id;
+    insertionSort(grammar.symbolsByName, NumSymbols, [&](int a, int b) { return grammar.names[a] < grammar.names[b]; });
+    return grammar;
+}
+
+// 共享算法所需的文法查询接口（见 lr_algorithms.h）
+template <typename G>
+struct GrammarView {
+    const G& grammar;
+
+    constexpr int numSymbols() const { return G::numSymbols; }
+    constexpr int numTerminals() const { return G::numTerminals; }
+    constexpr int numProductions() const { return G::numProductions; }
+    constexpr bool isTerminal(int symbol) const { return grammar.isTerminal(symbol); }
+    constexpr int leftOf(int prodIndex) const { return grammar.left[prodIndex]; }
+    constexpr int rightLength(int prodIndex) const { return grammar.length(prodIndex); }
+    constexpr int rightSymbol(int prodIndex, int i) const { return grammar.right[grammar.rightStart[prodIndex] + i]; }
+    template <typename F>
+    constexpr void forEachProductionOf(int nonTerminal, F f) const {
+        for (int p = 0; p < G::numProductions; p++) {
+            if (grammar.left[p] == nonTerminal) f(p);
+        }
+    }
+};
+
+// 共享算法的临时数组：容量取符号数、产生式数与右部符号总数之和，不小于其中任何一个算法所需的长度
+template <typename G>
+using Storage = lr_algorithms::FixedStorage<G::numSymbols + G::numProductions + G::numRightSymbols + 2>;
+
+// 闭包工作表中的项目
+struct Item {
+    int prod = 0;
+    int dot = 0;
+
+    constexpr Item() = default;
+    constexpr Item(int prodIndex, int dotPos) : prod(prodIndex), dot(dotPos) {}
+    constexpr int prodIndex() const { return prod; }
+    constexpr int dotPos() const { return dot; }
+};
+
+// 容量固定的顺序表
+template <typename T, int Capacity>
+struct FixedVector {
+    using value_type = T;
+    std::array<T, Capacity> values{};
+    std::size_t count = 0;
+
+    constexpr std::size_t size() const { return count; }
+    constexpr const T& operator[](std::size_t i) const { return values[i]; }
+    constexpr void push_back(const T& value) { values[count++] = value; }
+};
+
+// 计算项目集闭包（lr_algorithms::closeItems），项目集以按项目编号索引的位图表示
+// 每个产生式的初始项目至多加入一次，因此工作表不超过项目总数
+template <typename G>
+constexpr BitSet<G::numItems> closure(const G& grammar, const BitSet<G::numItems>& kernel) {
+    FixedVector<Item, G::numItems> items;
+    for (int item = 0; item < G::numItems; item++) {
+        if (!kernel.test(item)) continue;
+        int prodIndex = grammar.itemProduction[item];
+        items.push_back(Item(prodIndex, item - grammar.itemStart[prodIndex]));
+    }
+    lr_algorithms::closeItems<Storage<G>>(GrammarView<G>{ grammar }, items);
+
+    BitSet<G::numItems> result;
+    for (std::size_t k = 0; k < items.size(); k++) {
+        result.set(grammar.itemStart[items[k].prodIndex()] + items[k].dotPos());
+    }
+    return result;
+}
+
+// 构建LR(0)项目集族：按编号顺序处理状态，每个状态的后继按符号名次产生，与运行时的状态编号相同
+template <int Capacity, typename G>
+constexpr Automaton<Capacity, G::numSymbols, G::numItems> buildAutomaton(const G& grammar) {
+    Automaton<Capacity, G::numSymbols, G::numItems> automaton;
+    for (auto& target : automaton.transitions) target = -1;
+
+    auto findOrAddState = [&](const BitSet<G::numItems>& kernel) {
+        for (int state = 0; state < automaton.numStates; state++) {
+            if (automaton.kernels[state] == kernel) return state;
+        }
+        if (automaton.numStates == Capacity) {
+            throw std::logic_error("Too many LR(0) states; pass a larger MaxStates");
+        }
+        automaton.kernels[automaton.numStates] = kernel;
+        return automaton.numStates++;
+    };
+
+    BitSet<G::numItems> initial;
+    initial.set(grammar.itemStart[grammar.augmentedProductionIndex]);
+    findOrAddState(initial);
+
+    for (int state = 0; state < automaton.numStates; state++) {
+        BitSet<G::numItems> items = closure(grammar, automaton.kernels[state]);
+        for (int rank = 0; rank < G::numSymbols; rank++) {
+            int symbol = grammar.symbolsByName[rank];
+            BitSet<G::numItems> kernel;
+            bool any = false;
+            for (int item = 0; item < G::numItems; item++) {
+                if (items.test(item) && grammar.symbolAfterDot(item) == symbol) {
+                    kernel.set(item + 1);   // 移动点
+                    any = true;
+                }
+            }
+            if (any) {
+                automaton.transitions[state * G::numSymbols + symbol] = findOrAddState(kernel);
+            }
+        }
+    }
+    return automaton;
+}
+
+// 按实际状态数复制出大小恰好的自动机
+template <int NumStates, int Capacity, int NumSymbols, int NumItems>
+constexpr Automaton<NumStates, NumSymbols, NumItems> shrink(const Automaton<Capacity, NumSymbols, NumItems>& built) {
+    Automaton<NumStates, NumSymbols, NumItems> automaton;
+    automaton.numStates = NumStates;
+    for (int state = 0; state < NumStates; state++) {
+        automaton.kernels[state] = built.kernels[state];
+        for (int symbol = 0; symbol < NumSymbols; symbol++) {
+            automaton.transitions[state * NumSymbols + symbol] = built.transitions[state * NumSymbols + symbol];
+        }
+    }
+    return automaton;
+}
+
+// 计算FOLLOW集（先求可空性和FIRST集），与运行时使用同一份算法
+template <typename G>
+constexpr std::array<BitSet<G::numTerminals>, G::numSymbols> computeFollowSets(const G& grammar) {
+    GrammarView<G> view{ grammar };
+    std::array<bool, G::numSymbols> nullable{};
+    lr_algorithms::computeNullable<Storage<G>>(view, nullable);
+
+    std::array<BitSet<G::numTerminals>, G::numSymbols> firstSet{};
+    lr_algorithms::computeFirstSets<Storage<G>>(view, nullable, firstSet);
+
+    std::array<BitSet<G::numTerminals>, G::numSymbols> followSet{};
+    lr_algorithms::computeFollowSets<Storage<G>>(view, nullable, firstSet, grammar.startSymbol, grammar.endMarker, followSet);
+    return followSet;
+}
+
+// 构造分析表：useFollow为false时是LR(0)，为true时是SLR(1)
+// 与运行时的 buildLR0ParseTable / buildSLR1ParseTable 相同：每个状态按项目编号顺序处理规约项目，
+// 接受动作直接写入；LR(0)的规约覆盖已有动作，SLR(1)保留移进、规约-规约冲突时报错
+template <typename G, typename A>
+constexpr Tables<A::capacity, G::numTerminals, G::numNonTerminals, G::numProductions>
+buildTables(const G& grammar, const A& automaton, bool useFollow) {
+    Tables<A::capacity, G::numTerminals, G::numNonTerminals, G::numProductions> tables;
+    for (auto& target : tables.gotoTable) target = -1;
+    for (int p = 0; p < G::numProductions; p++) {
+        tables.productionLengths[p] = grammar.length(p);
+        tables.productionLefts[p] = grammar.left[p];
+    }
+    for (int term = 0; term < G::numTerminals; term++) tables.terminalNames[term] = grammar.names[term].base;
+    tables.endMarker = grammar.endMarker;
+
+    std::array<BitSet<G::numTerminals>, G::numSymbols> followSet{};
+    if (useFollow) followSet = computeFollowSets(grammar);
+
+    // 1. 移进和GOTO
+    for (int state = 0; state < A::capacity; state++) {
+        for (int symbol = 0; symbol < G::numSymbols; symbol++) {
+            int target = automaton.transitions[state * G::numSymbols + symbol];
+            if (target < 0) continue;
+            if (grammar.isTerminal(symbol)) {
+                tables.actionTable[state * G::numTerminals + symbol] = makeAction(ACTION_SHIFT, target);
+            } else {
+                tables.gotoTable[state * G::numNonTerminals + (symbol - G::numTerminals)] = target;
+            }
+        }
+    }
+
+    // 2. 规约和接受
+    for (int state = 0; state < A::capacity; state++) {
+        BitSet<G::numItems> items = closure(grammar, automaton.kernels[state]);
+        for (int item = 0; item < G::numItems; item++) {
+            if (!items.test(item) || grammar.symbolAfterDot(item) >= 0) continue;
+            int prodIndex = grammar.itemProduction[item];
+
+            // 接受项目：S' -> S·
+            if (prodIndex == grammar.augmentedProductionIndex) {
+                tables.actionTable[state * G::numTerminals + grammar.endMarker] = makeAction(ACTION_ACCEPT);
+                continue;
+            }
+
+            for (int term = 0; term < G::numTerminals; term++) {
+                std::uint32_t& existing = tables.actionTable[state * G::numTerminals + term];
+                if (!useFollow) {
+                    // LR(0)对所有终结符都添加规约动作，覆盖已有的动作
+                    if (actionKind(existing) != ACTION_ERROR) tables.conflicts++;
+                    existing = makeAction(ACTION_REDUCE, prodIndex);
+                    continue;
+                }
+
+                // SLR(1)只对FOLLOW集中的终结符规约
+                if (!followSet[grammar.left[prodIndex]].test(term)) continue;
+                if (actionKind(existing) == ACTION_SHIFT) {
+                    tables.conflicts++;
+                    continue;
+                }
+                if (actionKind(existing) == ACTION_REDUCE) {
+                    throw std::logic_error("Reduce-reduce conflict");
+                }
+                existing = makeAction(ACTION_REDUCE, prodIndex);
+            }
+        }
+    }
+    return tables;
+}
+
+// 默认的状态数上限：项目数的两倍，超出时编译报错，可通过MaxStates指定
+constexpr int defaultStateCapacity(int numItems) {
+    return 2 * numItems + 8;
+}
+
+}  // namespace detail
+
+// 编译期解析文法，G须提供 static constexpr std::string_view text
+template <typename G>
+constexpr auto grammar() {
+    constexpr auto parsed = detail::parseText<G::text.size()>(G::text);
+    return detail::intern<parsed.numTerminals + parsed.numNonTerminals, parsed.numTerminals,
+                          parsed.numProductions + 1, parsed.numRightSymbols + 1>(parsed);
+}
+
+// 编译期构造LR(0)自动机
+template <typename G, int MaxStates = 0>
+constexpr auto lr0Automaton() {
+    constexpr auto parsedGrammar = grammar<G>();
+    using GrammarType = decltype(parsedGrammar);
+    constexpr int capacity = MaxStates > 0 ? MaxStates : detail::defaultStateCapacity(GrammarType::numItems);
+    constexpr auto built = detail::buildAutomaton<capacity>(parsedGrammar);
+    return detail::shrink<built.numStates>(built);
+}
+
+// 编译期构造LR(0)分析表，冲突时规约覆盖已有动作（与运行时相同），冲突数见conflicts
+template <typename G, int MaxStates = 0>
+constexpr auto lr0Tables() {
+    return detail::buildTables(grammar<G>(), lr0Automaton<G, MaxStates>(), false);
+}
+
+// 编译期构造SLR(1)分析表，移进-规约冲突保留移进（计入conflicts），规约-规约冲突时编译报错
+template <typename G, int MaxStates = 0>
+constexpr auto slr1Tables() {
+    return detail::buildTables(grammar<G>(), lr0Automaton<G, MaxStates>(), true);
+}
+
+}  // namespace constexpr_lr
@@ -0,0 +1,255 @@
+// LR分析表构造中与数据表示无关的算法：运行时（main.cpp）和编译期（constexpr_lr.h）共用同一份实现
+// 全部是constexpr函数模板，用容量固定的数组实例化时可在编译期求值，用vector实例化时在运行时执行
+//
+// 算法通过下面的接口访问文法（G）：
+//   int numSymbols() / numTerminals() / numProductions()
+//   bool isTerminal(int symbol)
+//   int leftOf(int p) / rightLength(int p) / rightSymbol(int p, int i)
+//   void forEachProductionOf(int nonTerminal, F f)   // 按产生式编号从小到大对左部为nonTerminal的产生式调用f(p)
+// 临时数组由Storage::ints(n)分配（长度至少为n、初值全为0的int数组）
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace lr_algorithms {
+
+// 运行时存储：按需分配
+struct DynamicStorage {
+    static std::vector<int> ints(int n) { return std::vector<int>(static_cast<std::size_t>(n), 0); }
+};
+
+// 编译期存储：容量固定的数组，Capacity须不小于各算法所需的最大长度
+template <int Capacity>
+struct FixedStorage {
+    static constexpr std::array<int, Capacity> ints(int) { return {}; }
+};
+
+// 按起点分组存储的关系（CSR）：结点x的边为 edges[edgeStart[x], edgeStart[x+1])
+template <typename Storage>
+struct Relation {
+    decltype(Storage::ints(0)) edgeStart;
+    decltype(Storage::ints(0)) edges;
+};
+
+// 由边生成器构造关系：generate(add) 对每条边 x R y 调用 add(x, y)，会被调用两遍（计数、填充），
+// 因此必须是无副作用的；同一起点的边保持生成的顺序
+template <typename Storage, typename Generate>
+constexpr Relation<Storage> makeRelation(int numNodes, Generate generate) {
+    Relation<Storage> relation{ Storage::ints(numNodes + 1), Storage::ints(0) };
+    int numEdges = 0;
+    generate([&](int x, int) {
+        relation.edgeStart[x + 1]++;
+        numEdges++;
+    });
+    for (int x = 0; x < numNodes; x++) relation.edgeStart[x + 1] += relation.edgeStart[x];
+
+    relation.edges = Storage::ints(numEdges);
+    auto fill = Storage::ints(numNodes);
+    generate([&](int x, int y) {
+        relation.edges[relation.edgeStart[x] + fill[x]++] = y;
+    });
+    return relation;
+}
+
+// DeRemer–Pennello digraph算法：在关系R上求 F(x) = F'(x) ∪ ⋃{ F(y) | x R y }
+// sets 传入 F'，返回 F。按强连通分量遍历，同一分量内的结点共享结果，每条边只处理一次
+// sets[x] 须提供 unionWith，并可复制赋值
+template <typename Storage, typename Sets>
+constexpr void digraph(int numNodes, const Relation<Storage>& relation, Sets& sets) {
+    const int done = numNodes + 1;
+    auto depth = Storage::ints(numNodes);        // N(x)：0为未访问，done为已完成
+    auto nodeStack = Storage::ints(numNodes);    // Tarjan栈
+    int nodeStackSize = 0;
+    // 显式递归栈帧：结点、下一条待处理的边、结点入栈时的深度
+    auto frameNode = Storage::ints(numNodes);
+    auto frameEdge = Storage::ints(numNodes);
+    auto frameDepth = Storage::ints(numNodes);
+    int callStackSize = 0;
+
+    auto visit = [&](int x) {
+        nodeStack[nodeStackSize++] = x;
+        depth[x] = nodeStackSize;
+        frameNode[callStackSize] = x;
+        frameEdge[callStackSize] = relation.edgeStart[x];
+        frameDepth[callStackSize] = depth[x];
+        callStackSize++;
+    };
+
+    for (int start = 0; start < numNodes; start++) {
+        if (depth[start] != 0) continue;
+        visit(start);
+
+        while (callStackSize > 0) {
+            int top = callStackSize - 1;
+            int x = frameNode[top];
+
+            if (frameEdge[top] < relation.edgeStart[x + 1]) {
+                int y = relation.edges[frameEdge[top]++];
+                if (depth[y] == 0) {
+                    // 递归访问y，返回后再合并
+                    visit(y);
+                    continue;
+                }
+                if (depth[y] < depth[x]) depth[x] = depth[y];
+                sets[x].unionWith(sets[y]);
+                continue;
+            }
+
+            // x的所有边处理完毕：若x是分量的根，则弹出整个分量
+            int entryDepth = frameDepth[top];
+            callStackSize--;
+            if (depth[x] == entryDepth) {
+                while (true) {
+                    int member = nodeStack[--nodeStackSize];
+                    depth[member] = done;
+                    if (member == x) break;
+                    sets[member] = sets[x];
+                }
+            }
+
+            // 返回调用者，合并x的结果
+            if (callStackSize > 0) {
+                int parent = frameNode[callStackSize - 1];
+                if (depth[x] < depth[parent]) depth[parent] = depth[x];
+                sets[parent].unionWith(sets[x]);
+            }
+        }
+    }
+}
+
+// 计算可空性：nullable[A]为真当且仅当 A =>* ε（nullable传入时全为false）
+// 每个产生式记录右部中尚未确认可空的符号个数，归零时左部可空；含终结符的产生式永远不可空
+template <typename Storage, typename G, typename Flags>
+constexpr void computeNullable(const G& g, Flags& nullable) {
+    auto remaining = Storage::ints(g.numProductions());
+    auto worklist = Storage::ints(g.numSymbols());
+    int size = 0;
+
+    auto hasTerminal = [&](int p) {
+        for (int i = 0; i < g.rightLength(p); i++) {
+            if (g.isTerminal(g.rightSymbol(p, i))) return true;
+        }
+        return false;
+    };
+    // 非终结符 -> 其出现所在的（不含终结符的）产生式，每次出现一条边
+    auto occurrences = makeRelation<Storage>(g.numSymbols(), [&](auto add) {
+        for (int p = 0; p < g.numProductions(); p++) {
+            if (hasTerminal(p)) continue;
+            for (int i = 0; i < g.rightLength(p); i++) add(g.rightSymbol(p, i), p);
+        }
+    });
+
+    for (int p = 0; p < g.numProductions(); p++) {
+        remaining[p] = hasTerminal(p) ? -1 : g.rightLength(p);
+        if (remaining[p] == 0 && !nullable[g.leftOf(p)]) {
+            nullable[g.leftOf(p)] = true;
+            worklist[size++] = g.leftOf(p);
+        }
+    }
+
+    while (size > 0) {
+        int symbol = worklist[--size];
+        for (int e = occurrences.edgeStart[symbol]; e < occurrences.edgeStart[symbol + 1]; e++) {
+            int p = occurrences.edges[e];
+            if (--remaining[p] == 0 && !nullable[g.leftOf(p)]) {
+                nullable[g.leftOf(p)] = true;
+                worklist[size++] = g.leftOf(p);
+            }
+        }
+    }
+}
+
+// 计算FIRST集（firstSet传入时为按符号索引的空集合）
+// 直接FIRST：A -> α t β 且 α 可空时 t ∈ FIRST(A)；关系：A -> α B β 且 α 可空时 FIRST(A) ⊇ FIRST(B)
+// 在该关系上用digraph按强连通分量传播，每条关系边只处理一次
+template <typename Storage, typename G, typename Flags, typename Sets>
+constexpr void computeFirstSets(const G& g, const Flags& nullable, Sets& firstSet) {
+    // 所有终结符的FIRST集是自己
+    for (int term = 0; term < g.numTerminals(); term++) firstSet[term].set(term);
+
+    for (int p = 0; p < g.numProductions(); p++) {
+        for (int i = 0; i < g.rightLength(p); i++) {
+            int symbol = g.rightSymbol(p, i);
+            if (g.isTerminal(symbol)) firstSet[g.leftOf(p)].set(symbol);
+            if (!nullable[symbol]) break;
+        }
+    }
+    auto relation = makeRelation<Storage>(g.numSymbols(), [&](auto add) {
+        for (int p = 0; p < g.numProductions(); p++) {
+            for (int i = 0; i < g.rightLength(p); i++) {
+                int symbol = g.rightSymbol(p, i);
+                if (!g.isTerminal(symbol)) add(g.leftOf(p), symbol);
+                if (!nullable[symbol]) break;
+            }
+        }
+    });
+    digraph(g.numSymbols(), relation, firstSet);
+}
+
+// 计算FOLLOW集（followSet传入时为按符号索引的空集合）
+// 直接FOLLOW：B 出现在 A -> α B β 中时 FIRST(β) ⊆ FOLLOW(B)（遇到不可空符号为止），# ∈ FOLLOW(开始符号)
+// 关系：β 可空时 FOLLOW(B) ⊇ FOLLOW(A)；同样在该关系上用digraph传播
+template <typename Storage, typename G, typename Flags, typename Sets>
+constexpr void computeFollowSets(const G& g, const Flags& nullable, const Sets& firstSet,
+                                 int startSymbol, int endMarker, Sets& followSet) {
+    followSet[startSymbol].set(endMarker);
+
+    // 右部位置i之后的符号是否全部可空
+    auto restNullable = [&](int p, int i) {
+        for (int j = i + 1; j < g.rightLength(p); j++) {
+            if (!nullable[g.rightSymbol(p, j)]) return false;
+        }
+        return true;
+    };
+
+    for (int p = 0; p < g.numProductions(); p++) {
+        for (int i = 0; i < g.rightLength(p); i++) {
+            int symbol = g.rightSymbol(p, i);
+            if (g.isTerminal(symbol)) continue;
+            for (int j = i + 1; j < g.rightLength(p); j++) {
+                int next = g.rightSymbol(p, j);
+                followSet[symbol].unionWith(firstSet[next]);
+                if (!nullable[next]) break;
+            }
+        }
+    }
+    auto relation = makeRelation<Storage>(g.numSymbols(), [&](auto add) {
+        for (int p = 0; p < g.numProductions(); p++) {
+            for (int i = 0; i < g.rightLength(p); i++) {
+                int symbol = g.rightSymbol(p, i);
+                // 产生式右部末尾（或其后全部可空）的非终结符继承左部的FOLLOW集
+                if (!g.isTerminal(symbol) && symbol != g.leftOf(p) && restNullable(p, i)) add(symbol, g.leftOf(p));
+            }
+        }
+    });
+    digraph(g.numSymbols(), relation, followSet);
+}
+
+// 计算项目集闭包（工作表算法：每个项目只处理一次，每个非终结符只展开一次）
+// items 传入核心项目，闭包新增的项目 (p, 0) 依次追加在末尾（不排序、不去重）
+// Items 须提供 size / operator[] / push_back，其元素提供 prodIndex() / dotPos() 并可由 (p, 0) 构造
+template <typename Storage, typename G, typename Items>
+constexpr void closeItems(const G& g, Items& items) {
+    auto expanded = Storage::ints(g.numSymbols());  // 已展开过的非终结符
+    for (std::size_t k = 0; k < items.size(); k++) {
+        int p = items[k].prodIndex();
+        int dot = items[k].dotPos();
+
+        // 如果点在末尾，跳过
+        if (dot >= g.rightLength(p)) continue;
+
+        // 只展开尚未展开过的非终结符
+        int nextSymbol = g.rightSymbol(p, dot);
+        if (g.isTerminal(nextSymbol) || expanded[nextSymbol]) continue;
+        expanded[nextSymbol] = 1;
+
+        // 添加所有以该非终结符为左部的产生式（点在开头）
+        g.forEachProductionOf(nextSymbol, [&](int q) {
+            items.push_back(typename Items::value_type(q, 0));
+        });
+    }
+}
+
+}  // namespace lr_algorithms
@@ -12,6 +12,30 @@
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <cstdint>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <string_view>
+#include <chrono>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 与数据表示无关的构造算法（digraph、可空性、FIRST/FOLLOW、闭包），与编译期分析表共用
+#include "include/lr_algorithms.h"
 
 // 添加 Windows 版本定义
 #ifdef _WIN32
@@ -20,550 +44,283 @@
 
 using namespace std;
 
-// 文法产生式结构体
-struct Production {
-    string left;
-    vector<string> right;
+// 符号表：将文法符号驻留为稠密整数ID
+// 终结符占用 [0, numTerminals)，非终结符占用 [numTerminals, size())
+struct SymbolTable {
+    vector<string> names;              // ID -> 符号名
+    unordered_map<string, int> ids;    // 符号名 -> ID
+    int numTerminals = 0;              // 终结符个数（包含#）
 
-    // 修复ε产生式检测
-    bool isEpsilon() const {
-        if (right.empty()) return true;
-        if (right.size() == 1 && right[0] == "ε") return true;
-        return false;
+    void clear() {
+        names.clear();
+        ids.clear();
+        numTerminals = 0;
     }
-};
-
-// LR(0)项目：产生式索引 + 点位置
-struct Item {
-    int prodIndex;    // 产生式索引
-    int dotPos;       // 点的位置
 
-    bool operator==(const Item& other) const {
-        return prodIndex == other.prodIndex && dotPos == other.dotPos;
+    // 驻留符号，已存在时返回原有ID
+    int intern(const string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        int id = static_cast<int>(names.size());
+        names.push_back(name);
+        ids[name] = id;
+        return id;
     }
 
-    bool operator<(const Item& other) const {
-        if (prodIndex != other.prodIndex) return prodIndex < other.prodIndex;
-        return dotPos < other.dotPos;
+    // 查找符号ID，不存在时返回-1
+    int find(const string& name) const {
+        auto it = ids.find(name);
+        return it == ids.end() ? -1 : it->second;
     }
-};
 
-// 哈希函数特化
-namespace std {
-    template<>
-    struct hash<Item> {
-        size_t operator()(const Item& item) const {
-            return hash<int>()(item.prodIndex) ^ (hash<int>()(item.dotPos) << 1);
-        }
-    };
-}
+    const string& name(int id) const { return names[id]; }
+    int size() const { return static_cast<int>(names.size()); }
+    int numNonTerminals() const { return size() - numTerminals; }
+    bool isTerminal(int id) const { return id < numTerminals; }
+    bool isNonTerminal(int id) const { return id >= numTerminals; }
+};
 
-// 语法分析器基类
-class ParserBase {
+// 位图集合（用于按终结符ID索引的FIRST/FOLLOW/向前看集合）
+class BitSet {
 public:
-    // 文法组成部分
-    set<string> nonTerminals;   // 非终结符集合
-    set<string> terminals;      // 终结符集合（包含#）
-    vector<Production> productions;  // 产生式列表
-    string startSymbol;          // 开始符号
-
-    // 扩展后的文法
-    string augmentedStartSymbol; // 扩展后的开始符号（S'）
-    int augmentedProductionIndex; // 扩展产生式的索引
-
-    // LR(0)项目集族
-    vector<set<Item>> itemSets;  // 项目集族
-
-    // 分析表
-    map<pair<int, string>, string> actionTable; // ACTION表
-    map<pair<int, string>, int> gotoTable;      // GOTO表
-
-    // FIRST集和FOLLOW集
-    map<string, set<string>> firstSet;
-    map<string, set<string>> followSet;
-
-    // 分析过程步骤
-    struct ParseStep {
-        int step;
-        string stateStack;
-        string symbolStack;
-        string currentInput;
-        string remainingInput;
-        string action;
-    };
-
-    vector<ParseStep> parseSteps; // 存储分析过程
-    bool parseResult;             // 分析结果
+    BitSet() {}
+    explicit BitSet(int size) : words((size + 63) / 64, 0) {}
 
-    // 纯虚函数，由派生类实现
-    virtual void buildParseTable() = 0;
+    void set(int i) { words[i >> 6] |= (1ULL << (i & 63)); }
+    bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
 
-    // 清理所有缓存数据
-    virtual void clearCache() {
-        nonTerminals.clear();
-        terminals.clear();
-        productions.clear();
-        startSymbol.clear();
-        augmentedStartSymbol.clear();
-        augmentedProductionIndex = -1;
-        
-        itemSets.clear();
-        actionTable.clear();
-        gotoTable.clear();
-        firstSet.clear();
-        followSet.clear();
-        parseSteps.clear();
-        parseResult = false;
+    // 并入另一个集合，返回本集合是否发生变化
+    bool unionWith(const BitSet& other) {
+        bool changed = false;
+        for (size_t w = 0; w < words.size(); w++) {
+            uint64_t merged = words[w] | other.words[w];
+            if (merged != words[w]) {
+                words[w] = merged;
+                changed = true;
+            }
+        }
+        return changed;
     }
 
-    // 字符串分割函数
-    vector<string> split(const string& s, char delimiter) {
-        vector<string> tokens;
-        string token;
-        istringstream tokenStream(s);
-        while (getline(tokenStream, token, delimiter)) {
-            // 移除首尾空白字符
-            token.erase(0, token.find_first_not_of(" \t"));
-            token.erase(token.find_last_not_of(" \t") + 1);
-            if (!token.empty()) tokens.push_back(token);
+    bool intersects(const BitSet& other) const {
+        for (size_t w = 0; w < words.size(); w++) {
+            if (words[w] & other.words[w]) return true;
         }
-        return tokens;
+        return false;
     }
 
-    // 判断符号是否为终结符
-    bool isTerminal(const string& symbol) {
-        return terminals.count(symbol) || symbol == "#";
+    bool empty() const {
+        for (uint64_t w : words) {
+            if (w) return false;
+        }
+        return true;
     }
 
-    // 计算项目集闭包
-    set<Item> closure(const set<Item>& items) {
-        set<Item> closureSet = items;
-        bool changed;
-        do {
-            changed = false;
-            set<Item> newItems;
+    bool operator==(const BitSet& other) const { return words == other.words; }
 
-            // 遍历闭包中的每个项目
-            for (const auto& item : closureSet) {
-                const Production& prod = productions[item.prodIndex];
-
-                // 如果点在末尾，跳过
-                if (item.dotPos >= static_cast<int>(prod.right.size())) continue;
+    // 按从小到大的顺序遍历集合中的元素
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t w = 0; w < words.size(); w++) {
+            uint64_t bits = words[w];
+            while (bits) {
+                int bit = __builtin_ctzll(bits);
+                f(static_cast<int>(w * 64 + bit));
+                bits &= bits - 1;
+            }
+        }
+    }
 
-                string nextSymbol = prod.right[item.dotPos];
+    vector<uint64_t> words;
+};
 
-                // 如果下一个符号是非终结符
-                if (nonTerminals.count(nextSymbol)) {
-                    // 添加所有以该非终结符为左部的产生式
-                    for (size_t i = 0; i < productions.size(); i++) {
-                        if (productions[i].left == nextSymbol) {
-                            Item newItem{ static_cast<int>(i), 0 }; // 点在开头
-                            if (closureSet.find(newItem) == closureSet.end() &&
-                                newItems.find(newItem) == newItems.end()) {
-                                newItems.insert(newItem);
-                                changed = true;
-                            }
-                        }
-                    }
-                }
-            }
+// DeRemer–Pennello digraph算法：在关系R上求 F(x) = F'(x) ∪ ⋃{ F(y) | x R y }（实现见 lr_algorithms::digraph）
+// relation[x] 为x的全部后继，sets 传入 F'，返回 F
+inline void digraph(const vector<vector<int>>& relation, vector<BitSet>& sets) {
+    const int n = static_cast<int>(relation.size());
+    auto grouped = lr_algorithms::makeRelation<lr_algorithms::DynamicStorage>(n, [&](auto add) {
+        for (int x = 0; x < n; x++) {
+            for (int y : relation[x]) add(x, y);
+        }
+    });
+    lr_algorithms::digraph(n, grouped, sets);
+}
 
-            // 添加新项目到闭包
-            closureSet.insert(newItems.begin(), newItems.end());
-        } while (changed);
+// 文法产生式结构体（符号均为符号表中的ID）
+struct Production {
+    int left;
+    vector<int> right;   // ε产生式的右部为空
 
-        return closureSet;
+    bool isEpsilon() const {
+        return right.empty();
     }
+};
 
-    // 计算转移函数
-    set<Item> goTo(const set<Item>& items, const string& symbol) {
-        set<Item> result;
-
-        for (const auto& item : items) {
-            const Production& prod = productions[item.prodIndex];
+// LR(0)项目：产生式索引 + 点位置，打包为一个64位键
+// 高32位为产生式索引，低32位为点的位置，键的大小顺序即 (产生式索引, 点位置) 的字典序
+struct Item {
+    uint64_t key;
 
-            // 如果点在末尾，跳过
-            if (item.dotPos >= static_cast<int>(prod.right.size())) continue;
+    Item() : key(0) {}
+    Item(int prodIndex, int dotPos)
+        : key((static_cast<uint64_t>(prodIndex) << 32) | static_cast<uint32_t>(dotPos)) {}
 
-            // 如果当前符号匹配
-            if (prod.right[item.dotPos] == symbol) {
-                result.insert({ item.prodIndex, item.dotPos + 1 }); // 移动点
-            }
-        }
+    int prodIndex() const { return static_cast<int>(key >> 32); }  // 产生式索引
+    int dotPos() const { return static_cast<int>(key & 0xFFFFFFFFu); } // 点的位置
 
-        return closure(result);
+    bool operator==(const Item& other) const {
+        return key == other.key;
     }
 
-    // 构建LR(0)项目集族
-    void buildItemSets() {
-        itemSets.clear();
-        queue<int> unprocessedSets;
-        map<set<Item>, int> itemSetMap;  // 用于跟踪项目集和状态的映射
-    
-        // 创建初始项目集
-        set<Item> initialSet;
-        initialSet.insert({ augmentedProductionIndex, 0 });
-        initialSet = closure(initialSet);
-        itemSets.push_back(initialSet);
-        itemSetMap[initialSet] = 0;
-        unprocessedSets.push(0);
-    
-        while (!unprocessedSets.empty()) {
-            int currentIndex = unprocessedSets.front();
-            unprocessedSets.pop();
-            set<Item> currentSet = itemSets[currentIndex];
-    
-            set<string> allSymbols = terminals;
-            allSymbols.insert(nonTerminals.begin(), nonTerminals.end());
-            allSymbols.erase("ε");  // 移除ε符号
-    
-            for (const auto& symbol : allSymbols) {
-                set<Item> newSet = goTo(currentSet, symbol);
-    
-                if (!newSet.empty()) {
-                    // 检查新项目集是否已存在
-                    auto it = itemSetMap.find(newSet);
-                    int newIndex;
-    
-                    if (it == itemSetMap.end()) {
-                        newIndex = static_cast<int>(itemSets.size());
-                        itemSets.push_back(newSet);
-                        itemSetMap[newSet] = newIndex;
-                        unprocessedSets.push(newIndex);
-                    } else {
-                        newIndex = it->second;
-                    }
-    
-                    // 不再在此处修改actionTable和gotoTable
-                }
-            }
-        }
+    bool operator<(const Item& other) const {
+        return key < other.key;
     }
+};
 
-    // 计算FIRST集
-    void computeFirstSets() {
-        // 初始化，所有终结符的FIRST集是自己
-        for (const auto& term : terminals) {
-            firstSet[term] = { term };
-        }
+// 项目集：按键有序、无重复的连续数组
+using ItemSet = vector<Item>;
 
-        // 非终结符的FIRST集初始化
-        for (const auto& nt : nonTerminals) {
-            firstSet[nt] = {};
-        }
+// 项目集的64位指纹（FNV-1a），用于核心项目去重的哈希表
+inline uint64_t itemSetFingerprint(const ItemSet& items) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const auto& item : items) {
+        h ^= item.key;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
 
-        bool changed = true;
-        while (changed) {
-            changed = false;
-            for (const auto& prod : productions) {
-                const string& left = prod.left;
-                const vector<string>& right = prod.right;
+// 字符串的64位FNV-1a哈希
+inline uint64_t stringFingerprint(const string& text) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
 
-                // 如果是ε产生式
-                if (prod.isEpsilon()) {
-                    if (!firstSet[left].count("ε")) {
-                        firstSet[left].insert("ε");
-                        changed = true;
-                    }
-                    continue;
-                }
+// 标准Base64编码（带=填充）
+inline string base64Encode(const string& bytes) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    string encoded;
+    encoded.reserve((bytes.size() + 2) / 3 * 4);
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t chunk = static_cast<uint8_t>(bytes[i]) << 16;
+        if (i + 1 < bytes.size()) chunk |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+        if (i + 2 < bytes.size()) chunk |= static_cast<uint8_t>(bytes[i + 2]);
+        encoded += ALPHABET[(chunk >> 18) & 63];
+        encoded += ALPHABET[(chunk >> 12) & 63];
+        encoded += i + 1 < bytes.size() ? ALPHABET[(chunk >> 6) & 63] : '=';
+        encoded += i + 2 < bytes.size() ? ALPHABET[chunk & 63] : '=';
+    }
+    return encoded;
+}
 
-                size_t prevSize = firstSet[left].size();
-                bool allContainEpsilon = true;
+// 自动机的转移边：当前状态经symbol转移到target
+struct Transition {
+    int symbol;   // 转移符号ID
+    int target;   // 目标状态
+};
 
-                // 遍历右部符号
-                for (const auto& sym : right) {
-                    // 如果是终结符
-                    if (isTerminal(sym) && sym != "ε") {
-                        if (!firstSet[left].count(sym)) {
-                            firstSet[left].insert(sym);
-                            changed = true;
-                        }
-                        allContainEpsilon = false;
-                        break;
-                    }
+// ACTION表项打包为32位整数：高2位为动作类型，低30位为目标（状态号或产生式号）
+enum ActionKind : uint32_t {
+    ACTION_ERROR = 0,   // 空白表项（出错）
+    ACTION_SHIFT = 1,   // 移进，目标为状态号
+    ACTION_REDUCE = 2,  // 规约，目标为产生式号
+    ACTION_ACCEPT = 3   // 接受
+};
 
-                    // 非终结符
-                    const set<string>& symFirst = firstSet[sym];
-                    bool symContainsEpsilon = symFirst.count("ε") > 0;
+inline uint32_t makeAction(ActionKind kind, int target = 0) {
+    return (static_cast<uint32_t>(kind) << 30) | static_cast<uint32_t>(target);
+}
 
-                    // 将symFirst中非ε元素添加到left的FIRST集
-                    for (const auto& s : symFirst) {
-                        if (s != "ε" && !firstSet[left].count(s)) {
-                            firstSet[left].insert(s);
-                            changed = true;
-                        }
-                    }
+inline ActionKind actionKind(uint32_t action) {
+    return static_cast<ActionKind>(action >> 30);
+}
 
-                    // 如果当前符号没有ε，则停止
-                    if (!symContainsEpsilon) {
-                        allContainEpsilon = false;
-                        break;
-                    }
-                }
+inline int actionTarget(uint32_t action) {
+    return static_cast<int>(action & 0x3FFFFFFFu);
+}
 
-                // 如果所有右部符号都包含ε，则添加ε
-                if (allContainEpsilon && !firstSet[left].count("ε")) {
-                    firstSet[left].insert("ε");
-                    changed = true;
-                }
-            }
-        }
+// 表项转为 "s12" / "r3" / "acc" 形式的字符串
+inline string actionToString(uint32_t action) {
+    switch (actionKind(action)) {
+        case ACTION_SHIFT:  return "s" + to_string(actionTarget(action));
+        case ACTION_REDUCE: return "r" + to_string(actionTarget(action));
+        case ACTION_ACCEPT: return "acc";
+        default:            return "";
     }
+}
 
-    // 计算FOLLOW集
-    void computeFollowSets() {
-        // 初始化
-        for (const auto& nt : nonTerminals) {
-            followSet[nt] = {};
-        }
-        followSet[startSymbol].insert("#");
-    
-        bool changed = true;
-        while (changed) {
-            changed = false;
-            for (const auto& prod : productions) {
-                const string& left = prod.left;
-                const vector<string>& right = prod.right;
-    
-                for (size_t i = 0; i < right.size(); i++) {
-                    const string& symbol = right[i];
-                    if (!nonTerminals.count(symbol)) continue;
-    
-                    bool allCanBeEpsilon = true;
-                    for (size_t j = i + 1; j < right.size(); j++) {
-                        const string& next = right[j];
-                        
-                        // 添加FIRST(next) - {ε} 到FOLLOW(symbol)
-                        if (terminals.count(next) && next != "ε") {
-                            if (!followSet[symbol].count(next)) {
-                                followSet[symbol].insert(next);
-                                changed = true;
-                            }
-                            allCanBeEpsilon = false;
-                            break;
-                        }
-    
-                        // 非终结符
-                        for (const auto& s : firstSet[next]) {
-                            if (s != "ε" && !followSet[symbol].count(s)) {
-                                followSet[symbol].insert(s);
-                                changed = true;
-                            }
-                        }
-    
-                        // 如果FIRST(next)不包含ε，则停止
-                        if (!firstSet[next].count("ε")) {
-                            allCanBeEpsilon = false;
-                            break;
-                        }
-                    }
-    
-                    // 特殊处理：产生式右部末尾的非终结符
-                    if (i == right.size() - 1 || allCanBeEpsilon) {
-                        for (const auto& s : followSet[left]) {
-                            if (!followSet[symbol].count(s)) {
-                                followSet[symbol].insert(s);
-                                changed = true;
-                            }
-                        }
-                    }
-                }
-            }
+// 哈希函数特化
+namespace std {
+    template<>
+    struct hash<Item> {
+        size_t operator()(const Item& item) const {
+            return hash<uint64_t>()(item.key);
         }
-    }
+    };
+}
 
-    // 构建LR(0)分析表（纯LR(0)，不使用FOLLOW集）
-    virtual void buildLR0ParseTable() {
-        // 清理之前的缓存数据
-        actionTable.clear();
-        gotoTable.clear();
-        itemSets.clear();
-        
-        buildItemSets();
-        
-        // 1. 处理移进和GOTO动作
-        set<string> allSymbols = terminals;
-        allSymbols.insert(nonTerminals.begin(), nonTerminals.end());
-        allSymbols.erase("ε");  // 移除ε符号
-        
-        for (size_t i = 0; i < itemSets.size(); i++) {
-            const set<Item>& itemSet = itemSets[i];
-            
-            // 处理所有可能的符号
-            for (const auto& symbol : allSymbols) {
-                set<Item> newSet = goTo(itemSet, symbol);
-                if (!newSet.empty()) {
-                    // 查找新项目集对应的状态索引
-                    auto it = find(itemSets.begin(), itemSets.end(), newSet);
-                    if (it != itemSets.end()) {
-                        int newIndex = static_cast<int>(distance(itemSets.begin(), it));
-                        
-                        if (isTerminal(symbol)) {
-                            // LR(0)移进动作 - 直接添加，不检查冲突
-                            string actionKey = "s" + to_string(newIndex);
-                            actionTable[{static_cast<int>(i), symbol}] = actionKey;
-                        } else {
-                            // GOTO动作
-                            gotoTable[{static_cast<int>(i), symbol}] = newIndex;
-                        }
-                    }
-                }
-            }
-        }
-        
-        // 2. 处理规约和接受动作（LR(0)方式）
-        for (size_t i = 0; i < itemSets.size(); i++) {
-            const set<Item>& itemSet = itemSets[i];
-            
-            for (const auto& item : itemSet) {
-                const Production& prod = productions[item.prodIndex];
-                
-                // 点在末尾（规约项目）
-                if (static_cast<size_t>(item.dotPos) == prod.right.size()) {
-                    // 接受项目：S' -> S·
-                    if (item.prodIndex == augmentedProductionIndex) {
-                        actionTable[{static_cast<int>(i), "#"}] = "acc";
-                    }
-                    // 规约项目 - LR(0)对所有终结符都添加规约动作
-                    else {
-                        string actionKey = "r" + to_string(item.prodIndex);
-                        for (const auto& term : terminals) {
-                            if (term == "ε") continue;
-                            
-                            // LR(0)直接添加规约动作，可能产生冲突
-                            auto existingAction = actionTable.find({static_cast<int>(i), term});
-                            if (existingAction != actionTable.end()) {
-                                // 报告冲突但继续执行
-                                cout << "LR(0) Conflict in state " << i << ", symbol " << term 
-                                     << ": " << existingAction->second << " vs " << actionKey << endl;
-                            }
-                            actionTable[{static_cast<int>(i), term}] = actionKey;
-                        }
-                    }
-                }
-            }
-        }
-    }
+// LR自动机：每个状态只保存核心项目，完整闭包在构造分析表或输出JSON时按需展开
+struct Automaton {
+    vector<ItemSet> itemSets;                // 项目集族（核心项目）
+    vector<vector<Transition>> transitions;  // 每个状态的出边，与itemSets同步构造
+};
 
-    // 构建SLR(1)分析表
-    virtual void buildSLR1ParseTable() {
-        // 清理之前的缓存数据
-        actionTable.clear();
-        gotoTable.clear();
-        firstSet.clear();
-        followSet.clear();
-        itemSets.clear();
-        gotoTable.clear();
-    
-        computeFirstSets();
-        computeFollowSets();
-        buildItemSets();
-    
-        // 1. 处理移进和GOTO动作
-        set<string> allSymbols = terminals;
-        allSymbols.insert(nonTerminals.begin(), nonTerminals.end());
-        allSymbols.erase("ε");  // 移除ε符号
-    
-        for (size_t i = 0; i < itemSets.size(); i++) {
-            const set<Item>& itemSet = itemSets[i];
-            
-            // 处理所有可能的符号
-            for (const auto& symbol : allSymbols) {
-                set<Item> newSet = goTo(itemSet, symbol);
-                if (!newSet.empty()) {
-                    // 查找新项目集对应的状态索引
-                    auto it = find(itemSets.begin(), itemSets.end(), newSet);
-                    if (it != itemSets.end()) {
-                        int newIndex = static_cast<int>(distance(itemSets.begin(), it));
-                        
-                        if (isTerminal(symbol)) {
-                            // SLR(1)移进动作 - 只添加不冲突的移进
-                            string actionKey = "s" + to_string(newIndex);
-                            auto existingAction = actionTable.find({static_cast<int>(i), symbol});
-                            
-                            if (existingAction == actionTable.end()) {
-                                actionTable[{static_cast<int>(i), symbol}] = actionKey;
-                            }
-                        } else {
-                            // GOTO动作
-                            gotoTable[{static_cast<int>(i), symbol}] = newIndex;
-                        }
-                    }
-                }
-            }
-        }
-    
-        // 2. 处理规约和接受动作
-        for (size_t i = 0; i < itemSets.size(); i++) {
-            const set<Item>& itemSet = itemSets[i];
-    
-            for (const auto& item : itemSet) {
-                const Production& prod = productions[item.prodIndex];
-    
-                // 点在末尾（规约项目）
-                if (static_cast<size_t>(item.dotPos) == prod.right.size()) {
-                    // 接受项目：S' -> S·
-                    if (item.prodIndex == augmentedProductionIndex) {
-                        actionTable[{static_cast<int>(i), "#"}] = "acc";
-                    }
-                    // 规约项目 - SLR(1)使用FOLLOW集
-                    else {
-                        // 对该非终结符的FOLLOW集中的每个终结符添加规约动作
-                        const set<string>& follow = followSet[prod.left];
-                        for (const auto& term : follow) {
-                            if (term == "ε") continue;
-                            
-                            string actionKey = "r" + to_string(item.prodIndex);
-                            auto existingAction = actionTable.find({static_cast<int>(i), term});
-                            
-                            // 解决移进-规约冲突：优先移进
-                            if (existingAction != actionTable.end()) {
-                                if (existingAction->second[0] == 's') {
-                                    // 保留移进动作，跳过规约
-                                    continue;
-                                } else if (existingAction->second[0] == 'r') {
-                                    throw runtime_error("Reduce-reduce conflict in state " + 
-                                        to_string(i) + ", symbol " + term);
-                                }
-                            }
-                            
-                            actionTable[{static_cast<int>(i), term}] = actionKey;
-                        }
-                    }
-                }
-            }
-        }
-    }
+// 文法：加载后只读，由同一次加载得到的各个分析器共享
+// LR(0)自动机只取决于文法，在第一次需要时构造一次，供LR(0)/SLR(1)/LALR(1)分析表共用
+struct Grammar {
+    SymbolTable symbols;             // 符号表（终结符包含#）
+    vector<Production> productions;  // 产生式列表
+    vector<vector<int>> productionsByLeft; // 按左部索引的产生式编号（按符号ID索引）
+    int startSymbol = -1;            // 开始符号ID
+    int endMarker = -1;              // 结束符#的ID
+
+    // 扩展后的文法
+    int augmentedStartSymbol = -1;   // 扩展后的开始符号（S'）ID
+    int augmentedProductionIndex = -1; // 扩展产生式的索引
+
+    // 按符号名排序的全部符号ID及每个符号的名次，决定项目集族中状态的编号顺序
+    vector<int> symbolsByName;
+    vector<int> symbolRank;
 
     // 从输入加载文法
-    void loadGrammar(const vector<string>& grammar) {
-        nonTerminals.clear();
-        terminals.clear();
+    void load(const vector<string>& lines) {
+        symbols.clear();
         productions.clear();
+        productionsByLeft.clear();
+        symbolsByName.clear();
+        symbolRank.clear();
+
+        set<string> nonTerminalNames;   // 声明的非终结符
+        set<string> terminalNames;      // 声明的终结符
+        string startName;               // 开始符号
+        vector<pair<string, vector<string>>> rawProductions; // 尚未驻留的产生式
 
         bool parsingProductions = false;  // 标记是否在解析产生式部分
 
         // 逐行处理文法定义
-        for (const auto& line : grammar) {
+        for (const auto& line : lines) {
             if (line.find("NonTerminals:") != string::npos) {
                 // 解析非终结符
                 auto parts = split(line.substr(line.find(":") + 1), ',');
                 for (const auto& p : parts) {
-                    if (!p.empty()) nonTerminals.insert(p);
+                    if (!p.empty()) nonTerminalNames.insert(p);
                 }
             }
             else if (line.find("Terminals:") != string::npos) {
-                // 解析终结符
+                // 解析终结符（ε不是真正的终结符）
                 auto parts = split(line.substr(line.find(":") + 1), ',');
                 for (const auto& p : parts) {
-                    if (!p.empty()) terminals.insert(p);
+                    if (!p.empty() && p != "ε") terminalNames.insert(p);
                 }
-                terminals.insert("#"); // 确保包含结束符
             }
             else if (line.find("StartSymbol:") != string::npos) {
                 // 解析开始符号
-                startSymbol = split(line.substr(line.find(":") + 1), ' ')[0];
+                auto parts = split(line.substr(line.find(":") + 1), ' ');
+                if (!parts.empty()) startName = parts[0];
             }
             else if (line.find("Productions:") != string::npos) {
                 // 进入产生式解析部分
@@ -587,347 +344,4056 @@ public:
 
                 // 为每个候选式创建产生式
                 for (const auto& alt : alternatives) {
-                    Production prod;
-                    prod.left = left;
-                    vector<string> symbols = split(alt, ' ');
-                    for (const auto& s : symbols) {
+                    vector<string> right;
+                    vector<string> symbolNames = split(alt, ' ');
+                    for (const auto& s : symbolNames) {
                         if (s == "ε") {
-                            prod.right = { "ε" };
+                            right.clear(); // ε产生式右部为空
                             break;
                         }
                         else if (!s.empty()) {
-                            prod.right.push_back(s);
+                            right.push_back(s);
                         }
                     }
-                    productions.push_back(prod);
+                    rawProductions.push_back({ left, right });
                 }
             }
         }
 
+        if (!nonTerminalNames.count(startName)) {
+            throw runtime_error("Start symbol '" + startName + "' is not a declared nonterminal");
+        }
+
         // 文法扩展：添加S' -> S
-        augmentedStartSymbol = startSymbol + "'";
-        nonTerminals.insert(augmentedStartSymbol);
+        nonTerminalNames.insert(startName + "'");
+        terminalNames.insert("#"); // 确保包含结束符
+
+        // 驻留符号：先终结符后非终结符，各自按名字有序
+        for (const auto& t : terminalNames) {
+            if (nonTerminalNames.count(t)) {
+                throw runtime_error("Symbol '" + t + "' is declared as both terminal and nonterminal");
+            }
+            symbols.intern(t);
+        }
+        symbols.numTerminals = symbols.size();
+        for (const auto& nt : nonTerminalNames) {
+            symbols.intern(nt);
+        }
+
+        startSymbol = symbols.find(startName);
+        endMarker = symbols.find("#");
+        augmentedStartSymbol = symbols.find(startName + "'");
+
+        // 将产生式中的符号名转换为ID
+        auto resolve = [this](const string& name) {
+            int id = symbols.find(name);
+            if (id < 0) throw runtime_error("Undeclared symbol '" + name + "' in productions");
+            return id;
+        };
 
         Production augmentedProd;
         augmentedProd.left = augmentedStartSymbol;
         augmentedProd.right = { startSymbol };
-        productions.insert(productions.begin(), augmentedProd);
+        productions.push_back(augmentedProd);
         augmentedProductionIndex = 0; // 扩展产生式索引为0
-    }
-
-    // 语法分析过程
-    bool parse(const string& input) {
-        parseSteps.clear();
-        vector<string> tokens = split(input, ' ');
-        stack<int> stateStack;   // 状态栈
-        stack<string> symbolStack; // 符号栈
-        stateStack.push(0);       // 初始状态
-        symbolStack.push("#");     // 栈底符号
 
-        int step = 1;             // 步骤计数器
-        size_t inputPtr = 0;      // 输入指针
+        for (const auto& [left, right] : rawProductions) {
+            Production prod;
+            prod.left = resolve(left);
+            if (symbols.isTerminal(prod.left)) {
+                throw runtime_error("Terminal '" + left + "' cannot be the left side of a production");
+            }
+            for (const auto& s : right) {
+                prod.right.push_back(resolve(s));
+            }
+            productions.push_back(prod);
+        }
 
-        while (true) {
-            // 获取当前状态和输入符号
-            int currentState = stateStack.top();
-            string currentToken = (inputPtr < tokens.size()) ? tokens[inputPtr] : "#";
-
-            // 记录当前步骤信息
-            ParseStep ps;
-            ps.step = step;
-            ps.stateStack = stackToString(stateStack);
-            ps.symbolStack = stackToString(symbolStack);
-            ps.currentInput = currentToken;
-            ps.remainingInput = getRemainingInput(tokens, inputPtr);
-
-            // 查找ACTION表
-            auto actionIt = actionTable.find({ currentState, currentToken });
-            if (actionIt == actionTable.end()) {
-                ps.action = "Error: No ACTION entry";
-                parseSteps.push_back(ps);
-                parseResult = false;
-                return false;
-            }
+        // 建立左部 -> 产生式编号的索引
+        productionsByLeft.assign(symbols.size(), {});
+        for (size_t i = 0; i < productions.size(); i++) {
+            productionsByLeft[productions[i].left].push_back(static_cast<int>(i));
+        }
 
-            string action = actionIt->second;
-            string actionDesc;
+        // 全部符号按名字排序
+        for (int id = 0; id < symbols.size(); id++) {
+            symbolsByName.push_back(id);
+        }
+        sort(symbolsByName.begin(), symbolsByName.end(), [this](int a, int b) {
+            return symbols.name(a) < symbols.name(b);
+        });
+        symbolRank.assign(symbols.size(), 0);
+        for (size_t rank = 0; rank < symbolsByName.size(); rank++) {
+            symbolRank[symbolsByName[rank]] = static_cast<int>(rank);
+        }
+    }
 
-            // 处理动作
-            if (action == "acc") {
-                // 接受
-                ps.action = "Accept";
-                parseSteps.push_back(ps);
-                parseResult = true;
-                return true;
+    // 规范化的文法文本：开始符号、有序的终结符和非终结符、逐行的产生式
+    // 与声明顺序、空白和候选式的写法（| 或分行）无关，用作文法内容哈希的输入
+    string normalized() const {
+        string text = "start " + symbols.name(startSymbol) + "\nterminals";
+        for (int id = 0; id < symbols.numTerminals; id++) {
+            text += " " + symbols.name(id);
+        }
+        text += "\nnonterminals";
+        for (int id = symbols.numTerminals; id < symbols.size(); id++) {
+            text += " " + symbols.name(id);
+        }
+        text += "\n";
+        for (const auto& prod : productions) {
+            text += symbols.name(prod.left) + " ->";
+            for (int sym : prod.right) {
+                text += " " + symbols.name(sym);
             }
-            else if (action[0] == 's') {
-                // 移进动作
-                int nextState = stoi(action.substr(1));
-                stateStack.push(nextState);
-                symbolStack.push(currentToken);
-                actionDesc = "Shift to state " + to_string(nextState);
-                inputPtr++;
+            text += "\n";
+        }
+        return text;
+    }
+
+    // lr_algorithms 中共享算法使用的文法查询接口
+    int numSymbols() const { return symbols.size(); }
+    int numTerminals() const { return symbols.numTerminals; }
+    int numProductions() const { return static_cast<int>(productions.size()); }
+    bool isTerminal(int symbol) const { return symbols.isTerminal(symbol); }
+    int leftOf(int prodIndex) const { return productions[prodIndex].left; }
+    int rightLength(int prodIndex) const { return static_cast<int>(productions[prodIndex].right.size()); }
+    int rightSymbol(int prodIndex, int i) const { return productions[prodIndex].right[i]; }
+    template <typename F>
+    void forEachProductionOf(int nonTerminal, F f) const {
+        for (int prodIndex : productionsByLeft[nonTerminal]) f(prodIndex);
+    }
+
+    // 字符串分割函数
+    static vector<string> split(const string& s, char delimiter) {
+        vector<string> tokens;
+        string token;
+        istringstream tokenStream(s);
+        while (getline(tokenStream, token, delimiter)) {
+            // 移除首尾空白字符
+            token.erase(0, token.find_first_not_of(" \t"));
+            token.erase(token.find_last_not_of(" \t") + 1);
+            if (!token.empty()) tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    // 计算项目集闭包（工作表算法见 lr_algorithms::closeItems），结果有序、无重复
+    ItemSet closure(const ItemSet& items) const {
+        ItemSet closureSet = items;
+        lr_algorithms::closeItems<lr_algorithms::DynamicStorage>(*this, closureSet);
+        sort(closureSet.begin(), closureSet.end());
+        closureSet.erase(unique(closureSet.begin(), closureSet.end()), closureSet.end());
+        return closureSet;
+    }
+
+    // 计算转移函数
+    ItemSet goTo(const ItemSet& items, int symbol) const {
+        ItemSet result;
+
+        for (const auto& item : items) {
+            const Production& prod = productions[item.prodIndex()];
+
+            // 如果点在末尾，跳过
+            if (item.dotPos() >= static_cast<int>(prod.right.size())) continue;
+
+            // 如果当前符号匹配
+            if (prod.right[item.dotPos()] == symbol) {
+                result.push_back(Item(item.prodIndex(), item.dotPos() + 1)); // 移动点
             }
-            else if (action[0] == 'r') {
-                // 规约动作
-                int prodIndex = stoi(action.substr(1));
-                Production prod = productions[prodIndex];
+        }
 
-                // 弹出产生式右部
-                for (size_t i = 0; i < prod.right.size(); i++) {
-                    // 修复：正确处理ε产生式
-                    if (prod.isEpsilon()) {
-                        break; // 不需要弹出任何符号
-                    }
-                    stateStack.pop();
-                    symbolStack.pop();
-                }
+        return closure(result);
+    }
 
-                // 获取规约前的状态
-                int prevState = stateStack.top();
-                string leftSymbol = prod.left;
+    // 枚举项目集的全部后继：一次遍历按点后符号对项目分组，得到每个转移符号的核心项目
+    // 结果按符号名次排列，与逐个符号尝试goTo时的顺序一致；每个核心项目集保持有序
+    vector<pair<int, ItemSet>> successorKernels(const ItemSet& items) const {
+        vector<pair<int, Item>> advanced;  // (符号名次, 移动点后的项目)
 
-                // 查找GOTO表
-                auto gotoIt = gotoTable.find({ prevState, leftSymbol });
-                if (gotoIt == gotoTable.end()) {
-                    ps.action = "Error: No GOTO entry";
-                    parseSteps.push_back(ps);
-                    parseResult = false;
-                    return false;
-                }
+        for (const auto& item : items) {
+            const Production& prod = productions[item.prodIndex()];
 
-                // 压入新状态和符号
-                int nextState = gotoIt->second;
-                stateStack.push(nextState);
-                symbolStack.push(leftSymbol);
+            // 如果点在末尾，没有后继
+            if (item.dotPos() >= static_cast<int>(prod.right.size())) continue;
 
-                actionDesc = "Reduce: " + prod.left + " -> ";
-                for (const auto& sym : prod.right) {
-                    actionDesc += sym + " ";
-                }
+            int symbol = prod.right[item.dotPos()];
+            advanced.push_back({ symbolRank[symbol], Item(item.prodIndex(), item.dotPos() + 1) });
+        }
+        sort(advanced.begin(), advanced.end());
+
+        vector<pair<int, ItemSet>> result;
+        for (const auto& [rank, item] : advanced) {
+            if (result.empty() || result.back().first != symbolsByName[rank]) {
+                result.push_back({ symbolsByName[rank], {} });
             }
+            result.back().second.push_back(item);
+        }
+        return result;
+    }
 
-            ps.action = actionDesc;
-            parseSteps.push_back(ps);
-            step++;
+    // 取得LR(0)自动机（首次调用时构造，之后直接返回同一份）
+    shared_ptr<const Automaton> lr0Automaton() const {
+        if (productions.empty()) {
+            throw runtime_error("Grammar has not been loaded");
         }
+        call_once(lr0Built, [this]() { lr0 = buildLR0Automaton(); });
+        return lr0;
+    }
 
-        parseResult = false;
-        return false;
+private:
+    // 构建LR(0)项目集族
+    shared_ptr<const Automaton> buildLR0Automaton() const {
+        auto built = make_shared<Automaton>();
+        vector<ItemSet>& itemSets = built->itemSets;
+        vector<vector<Transition>>& transitions = built->transitions;
+        queue<int> unprocessedSets;
+        // 核心项目指纹 -> 状态编号（指纹冲突时逐一比较核心项目）
+        // LR(0)中闭包由核心唯一确定，因此按核心去重等价于按完整项目集去重
+        unordered_map<uint64_t, vector<int>> kernelIndex;
+
+        // 查找核心项目集对应的状态，不存在时新建
+        auto findOrAddState = [&](ItemSet&& kernel) {
+            vector<int>& bucket = kernelIndex[itemSetFingerprint(kernel)];
+            for (int state : bucket) {
+                if (itemSets[state] == kernel) return state;
+            }
+            int newIndex = static_cast<int>(itemSets.size());
+            itemSets.push_back(move(kernel));
+            transitions.emplace_back();
+            bucket.push_back(newIndex);
+            unprocessedSets.push(newIndex);
+            return newIndex;
+        };
+
+        // 创建初始项目集
+        findOrAddState({ Item(augmentedProductionIndex, 0) });
+
+        while (!unprocessedSets.empty()) {
+            int currentIndex = unprocessedSets.front();
+            unprocessedSets.pop();
+
+            // 展开当前状态的闭包（用完即丢弃），只对点后实际出现的符号求后继
+            for (auto& [symbol, kernel] : successorKernels(closure(itemSets[currentIndex]))) {
+                int newIndex = findOrAddState(move(kernel));
+
+                // 记录转移边，供各分析表构造时直接使用
+                transitions[currentIndex].push_back({ symbol, newIndex });
+            }
+        }
+        return built;
     }
 
-    // 将内部数据转换为Crow JSON格式
-    crow::json::wvalue toJson() {
-        crow::json::wvalue result;
-        
-        // 文法信息
-        result["start_symbol"] = startSymbol;
-        result["augmented_start_symbol"] = augmentedStartSymbol;
-        
-        // 非终结符
-        vector<string> ntVec;
-        for (const auto& nt : nonTerminals) {
-            ntVec.push_back(nt);
+    mutable once_flag lr0Built;
+    mutable shared_ptr<const Automaton> lr0;
+};
+
+// 编译好的文法的二进制格式（小端，各段按8字节对齐），可直接mmap后使用而无需反序列化：
+// 文件头 | 符号名偏移[numSymbols+1] | 符号名字节 | 产生式左部[numProductions] | 右部偏移[numProductions+1]
+// | 右部符号 | ACTION[numStates*numTerminals] | GOTO[numStates*numNonTerminals]
+// | 可选：核心项目偏移[numStates+1] | 核心项目（Item::key）
+// 终结符的ID按名字有序，因此查找输入符号时可以直接在映射的内存上二分
+const char COMPILED_MAGIC[8] = { 'F', 'E', 'I', 'S', 'U', 'L', 'R', '\0' };
+const uint32_t COMPILED_VERSION = 1;
+const uint32_t COMPILED_BYTE_ORDER = 0x01020304;
+const uint32_t COMPILED_HAS_ITEM_SETS = 1;
+const char* const PARSER_KINDS[] = { "lr0", "slr1", "lalr1", "lr1" };
+
+struct CompiledHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;              // 写入COMPILED_BYTE_ORDER，用于识别字节序不同的文件
+    uint32_t kind;                   // PARSER_KINDS的下标
+    uint32_t flags;
+    uint64_t grammarHash;            // 规范化文法的哈希，即文法ID
+    int32_t numSymbols;
+    int32_t numTerminals;
+    int32_t numProductions;
+    int32_t numStates;
+    int32_t startSymbol;
+    int32_t endMarker;
+    int32_t augmentedStartSymbol;
+    int32_t augmentedProductionIndex;
+    // 各段相对文件开头的字节偏移
+    uint64_t symbolOffsetsAt;
+    uint64_t symbolNamesAt;
+    uint64_t prodLeftAt;
+    uint64_t prodRightOffsetsAt;
+    uint64_t prodRightAt;
+    uint64_t actionAt;
+    uint64_t gotoAt;
+    uint64_t kernelOffsetsAt;        // 不含项目集时为0
+    uint64_t kernelItemsAt;
+    uint64_t fileSize;
+};
+
+// 常驻工作线程池（由服务器持有，供批量识别使用）：各请求提交的批任务排队，
+// 池中固定数量的线程和提交任务的线程一起通过原子下标领取工作，
+// 因此并发的批量请求共享同一组线程，不会按请求数成倍地创建线程
+class WorkerPool {
+public:
+    explicit WorkerPool(size_t numThreads) {
+        for (size_t i = 0; i < numThreads; i++) {
+            threads.emplace_back([this] { workerLoop(); });
         }
-        result["non_terminals"] = ntVec;
-        
-        // 终结符
-        vector<string> tVec;
-        for (const auto& t : terminals) {
-            tVec.push_back(t);
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            stopping = true;
         }
-        result["terminals"] = tVec;
-        
-        // 产生式
-        vector<string> prodStrs;
-        for (size_t i = 0; i < productions.size(); i++) {
-            string prodStr = to_string(i) + ": " + productions[i].left + " -> ";
-            for (const auto& sym : productions[i].right) {
-                prodStr += sym + " ";
+        wake.notify_all();
+        for (auto& th : threads) {
+            th.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return threads.size(); }
+
+    // 对 [0, count) 的每个下标调用一次body，全部完成后返回；body不应抛出异常
+    void run(size_t count, const function<void(size_t)>& body) {
+        auto job = make_shared<Job>(count, body);
+        bool queued = !threads.empty() && count > 1;
+        if (queued) {
+            {
+                lock_guard<mutex> lock(queueMutex);
+                jobs.push_back(job);
             }
-            prodStrs.push_back(prodStr);
+            wake.notify_all();
         }
-        result["productions"] = prodStrs;
-        
-        // FIRST集
-        crow::json::wvalue firstJson;
-        for (const auto& [key, value] : firstSet) {
-            if (key == augmentedStartSymbol) continue;
-            vector<string> vals;
-            for (const auto& v : value) {
-                vals.push_back(v);
+
+        job->work();  // 当前线程也参与
+
+        // 下标已全部领取完，从队列中撤下，再等待其他线程手上的部分完成
+        if (queued) {
+            lock_guard<mutex> lock(queueMutex);
+            auto it = find(jobs.begin(), jobs.end(), job);
+            if (it != jobs.end()) jobs.erase(it);
+        }
+        unique_lock<mutex> lock(job->doneMutex);
+        job->allDone.wait(lock, [&] { return job->done.load() == count; });
+    }
+
+private:
+    struct Job {
+        Job(size_t count, const function<void(size_t)>& body) : count(count), body(body) {}
+
+        bool exhausted() const { return next.load() >= count; }
+
+        void work() {
+            size_t completed = 0;
+            for (size_t i = next++; i < count; i = next++) {
+                body(i);
+                completed++;
+            }
+            if (completed > 0 && (done += completed) == count) {
+                lock_guard<mutex> lock(doneMutex);
+                allDone.notify_all();
             }
-            firstJson[key] = move(vals);
         }
-        result["first_set"] = move(firstJson);
-        
-        // FOLLOW集
-        crow::json::wvalue followJson;
-        for (const auto& [key, value] : followSet) {
-            if (key == augmentedStartSymbol) continue;
-            vector<string> vals;
-            for (const auto& v : value) {
-                vals.push_back(v);
+
+        const size_t count;
+        const function<void(size_t)>& body;  // 提交者在run()返回前保证其有效
+        atomic<size_t> next{0};
+        atomic<size_t> done{0};
+        mutex doneMutex;
+        condition_variable allDone;
+    };
+
+    void workerLoop() {
+        for (;;) {
+            shared_ptr<Job> job;
+            {
+                unique_lock<mutex> lock(queueMutex);
+                wake.wait(lock, [&] {
+                    while (!jobs.empty() && jobs.front()->exhausted()) jobs.pop_front();
+                    return stopping || !jobs.empty();
+                });
+                if (stopping) return;
+                job = jobs.front();
             }
-            followJson[key] = move(vals);
+            job->work();
         }
-        result["follow_set"] = move(followJson);
-        
-        // 项目集族
-        vector<crow::json::wvalue> itemSetJson;
-        for (size_t i = 0; i < itemSets.size(); i++) {
-            crow::json::wvalue setJson;
-            setJson["state"] = static_cast<int>(i);
-            
-            vector<string> items;
-            for (const auto& item : itemSets[i]) {
-                const Production& prod = productions[item.prodIndex];
-                string itemStr = prod.left + " -> ";
-                
-                for (size_t j = 0; j < prod.right.size(); j++) {
-                    if (static_cast<int>(j) == item.dotPos) itemStr += ". ";
-                    itemStr += prod.right[j] + " ";
+    }
+
+    vector<thread> threads;
+    deque<shared_ptr<Job>> jobs;
+    mutex queueMutex;
+    condition_variable wake;
+    bool stopping = false;
+};
+
+template <typename Tables>
+class PushParser;
+
+// 语法分析器基类
+class ParserBase {
+public:
+    // 文法（可与其他分析器共享）
+    shared_ptr<const Grammar> grammar = make_shared<const Grammar>();
+
+    // 自动机：LR(0)/SLR(1)/LALR(1)使用文法共享的LR(0)自动机，LR(1)使用自己构造的自动机
+    shared_ptr<const Automaton> automaton = make_shared<const Automaton>();
+
+    // LR(1)自动机：核心项目的向前看集合（与itemSets[i]逐项对应，仅LR(1)构造时非空）
+    vector<vector<BitSet>> kernelLookaheads;
+    int lr1StatesMerged = 0;   // 按弱相容性并入已有同核心状态的不同向前看集合组数（不合并时各自是一个状态）
+    int lr1ItemSetsBuilt = 0;  // 构造过程中建立的项目集数（删除不可达状态之前）
+
+    // 分析表：按行存储的稠密二维数组
+    // ACTION表为 状态数 × 终结符数 的打包动作，GOTO表为 状态数 × 非终结符数 的目标状态（-1表示空）
+    vector<uint32_t> actionTable; // ACTION表
+    vector<int> gotoTable;        // GOTO表
+
+    // FIRST集和FOLLOW集（按符号ID索引的终结符位图）
+    vector<BitSet> firstSet;
+    vector<bool> nullable;       // 符号能否推导出ε
+    vector<BitSet> followSet;
+
+    // 分析过程步骤（仅在序列化时由操作日志重建）
+    struct ParseStep {
+        int step;
+        string stateStack;
+        string symbolStack;
+        string currentInput;
+        string remainingInput;
+        string action;
+    };
+
+    // 分析过程中的一步操作：只记录相对上一步的变化，栈内容在重放时得到
+    struct ParseOp {
+        uint32_t action;    // 本步查到的ACTION表项，ACTION_ERROR表示没有表项
+        int gotoTarget;     // 规约后转移到的状态，-1表示没有GOTO表项
+        int inputPos;       // 本步开始时的输入指针
+    };
+
+    // 轨迹检查点：所有历史栈共享前缀，存成父指针树；每隔固定步数记录一次栈顶节点，
+    // 读取任意窗口时从最近的检查点重放，代价与窗口大小而非前缀长度相关
+    struct TraceStackNode {
+        int state;
+        int symbol;
+        int parent;
+    };
+    static const int TRACE_CHECKPOINT_INTERVAL = 256;
+
+    // 具体语法树：结点在每次分析独占的池中顺序分配（不逐个new），
+    // LR分析建立结点的顺序恰好是语法树的后序；每个结点的子结点下标在children中占一段连续区间
+    struct ParseTree {
+        struct Node {
+            int production;   // 规约所用的产生式，终结符结点为-1
+            int symbol;
+            int firstChild;   // 子结点下标在children中的起始位置
+            int childCount;
+            int tokenStart;   // 覆盖的输入符号区间 [tokenStart, tokenEnd)
+            int tokenEnd;
+        };
+        vector<Node> nodes;
+        vector<int> children;
+        int root = -1;        // 接受时为开始符号的结点
+    };
+
+    // 一次分析的轨迹：由发起分析的请求独占，分析器本身在构造完成后只读
+    struct ParseTrace {
+        int id = 0;               // 轨迹句柄，按窗口读取步骤时用它确认轨迹仍有效
+        vector<ParseOp> ops;      // 分析过程的操作日志
+        vector<string> tokens;    // 被分析的输入符号
+        vector<int> tokenIds;     // 输入符号的终结符ID，未知符号为-1
+        bool accepted = false;    // 分析结果
+        ParseTree tree;           // 规约时建立的语法树，接受时完整
+
+        // 检查点在第一次读取窗口时建立，可能有多个请求同时读取同一条轨迹
+        mutable once_flag checkpointsBuilt;
+        mutable vector<TraceStackNode> stackNodes;
+        mutable vector<int> checkpoints;  // 第 k*TRACE_CHECKPOINT_INTERVAL 步开始时的栈顶节点
+
+        // 估计占用的字节数，按窗口读取时才建立的检查点也预先计入（栈节点数不超过操作数）
+        size_t memoryUsage() const {
+            size_t bytes = sizeof(ParseTrace);
+            bytes += ops.capacity() * sizeof(ParseOp) + tokenIds.capacity() * sizeof(int);
+            for (const auto& token : tokens) bytes += sizeof(string) + token.capacity();
+            bytes += tree.nodes.capacity() * sizeof(ParseTree::Node) + tree.children.capacity() * sizeof(int);
+            bytes += ops.size() * sizeof(TraceStackNode) + (ops.size() / TRACE_CHECKPOINT_INTERVAL + 1) * sizeof(int);
+            return bytes;
+        }
+    };
+
+    inline static atomic<int> nextTraceId{1};
+
+    // 仅识别模式（不记录分析步骤）的结果
+    struct RecognizeResult {
+        bool accepted = false;
+        int errorPosition = -1;   // 出错时所在输入符号的下标（输入结束时为符号个数），接受时为-1
+        int steps = 0;            // 分析步数，与parse()记录的步骤数一致
+    };
+
+    // 纯虚函数，由派生类实现
+    virtual void buildParseTable() = 0;
+
+    // 复制出一个可修改的分析器，用于在已发布的只读快照基础上重新构造
+    virtual shared_ptr<ParserBase> clone() const = 0;
+
+    // 分析器种类，即PARSER_KINDS中的名字
+    virtual string kindName() const = 0;
+
+    virtual ~ParserBase() {}
+
+    // 清理所有缓存数据
+    virtual void clearCache() {
+        grammar = make_shared<const Grammar>();
+        automaton = make_shared<const Automaton>();
+        kernelLookaheads.clear();
+        lr1StatesMerged = 0;
+        lr1ItemSetsBuilt = 0;
+        actionTable.clear();
+        gotoTable.clear();
+        firstSet.clear();
+        nullable.clear();
+        followSet.clear();
+    }
+
+    // 查询ACTION表项
+    uint32_t& action(int state, int terminal) {
+        return actionTable[static_cast<size_t>(state) * grammar->symbols.numTerminals + terminal];
+    }
+
+    uint32_t action(int state, int terminal) const {
+        return actionTable[static_cast<size_t>(state) * grammar->symbols.numTerminals + terminal];
+    }
+
+    // 查询GOTO表项（nonTerminal为非终结符的符号ID）
+    int& gotoState(int state, int nonTerminal) {
+        return gotoTable[static_cast<size_t>(state) * grammar->symbols.numNonTerminals() + (nonTerminal - grammar->symbols.numTerminals)];
+    }
+
+    int gotoState(int state, int nonTerminal) const {
+        return gotoTable[static_cast<size_t>(state) * grammar->symbols.numNonTerminals() + (nonTerminal - grammar->symbols.numTerminals)];
+    }
+
+    // 分析表查询接口（与TableView相同，供recognizeWith使用）
+    int terminalId(const string& name) const {
+        int id = grammar->symbols.find(name);
+        return id >= 0 && grammar->symbols.isTerminal(id) ? id : -1;
+    }
+    int endMarkerId() const { return grammar->endMarker; }
+    int productionLength(int prodIndex) const { return static_cast<int>(grammar->productions[prodIndex].right.size()); }
+    int productionLeft(int prodIndex) const { return grammar->productions[prodIndex].left; }
+
+    // 根据自动机的转移边填写移进动作和GOTO表（须在填写规约动作之前调用）
+    void fillShiftAndGotoActions() {
+        for (size_t i = 0; i < automaton->itemSets.size(); i++) {
+            for (const auto& [symbol, newIndex] : automaton->transitions[i]) {
+                if (grammar->symbols.isTerminal(symbol)) {
+                    action(static_cast<int>(i), symbol) = makeAction(ACTION_SHIFT, newIndex);
+                } else {
+                    gotoState(static_cast<int>(i), symbol) = newIndex;
                 }
-                
-                if (item.dotPos == static_cast<int>(prod.right.size())) {
-                    itemStr += ".";
+            }
+        }
+    }
+
+    // 添加规约动作：移进-规约冲突时优先移进，规约-规约冲突时报错（GLR分析器改为保留冲突）
+    virtual void addReduceAction(int state, int term, int prodIndex) {
+        uint32_t& existingAction = action(state, term);
+
+        if (actionKind(existingAction) == ACTION_SHIFT) {
+            // 保留移进动作，跳过规约
+            return;
+        } else if (actionKind(existingAction) == ACTION_REDUCE) {
+            throw runtime_error("Reduce-reduce conflict in state " +
+                to_string(state) + ", symbol " + grammar->symbols.name(term));
+        }
+
+        existingAction = makeAction(ACTION_REDUCE, prodIndex);
+    }
+
+    // 按当前项目集族的大小分配空白的ACTION/GOTO表
+    void allocateTables() {
+        actionTable.assign(automaton->itemSets.size() * grammar->symbols.numTerminals, makeAction(ACTION_ERROR));
+        gotoTable.assign(automaton->itemSets.size() * grammar->symbols.numNonTerminals(), -1);
+    }
+
+    // 按需展开某个状态的完整项目集
+    ItemSet stateItems(int state) const {
+        return grammar->closure(automaton->itemSets[state]);
+    }
+
+    // 取得文法的LR(0)项目集族（与同一文法的其他分析器共享，只构造一次）
+    void buildItemSets() {
+        automaton = grammar->lr0Automaton();
+        kernelLookaheads.clear();
+    }
+
+    // 计算可空性：nullable[A]为真当且仅当 A =>* ε（算法见 lr_algorithms::computeNullable）
+    void computeNullable() {
+        nullable.assign(grammar->symbols.size(), false);
+        lr_algorithms::computeNullable<lr_algorithms::DynamicStorage>(*grammar, nullable);
+    }
+
+    // 计算FIRST集：直接FIRST加上在 FIRST(A) ⊇ FIRST(B) 关系上的digraph传播（见 lr_algorithms::computeFirstSets）
+    void computeFirstSets() {
+        computeNullable();
+        firstSet.assign(grammar->symbols.size(), BitSet(grammar->symbols.numTerminals));
+        lr_algorithms::computeFirstSets<lr_algorithms::DynamicStorage>(*grammar, nullable, firstSet);
+    }
+
+    // 计算FOLLOW集：直接FOLLOW加上在 FOLLOW(B) ⊇ FOLLOW(A) 关系上的digraph传播（见 lr_algorithms::computeFollowSets）
+    void computeFollowSets() {
+        followSet.assign(grammar->symbols.size(), BitSet(grammar->symbols.numTerminals));
+        lr_algorithms::computeFollowSets<lr_algorithms::DynamicStorage>(*grammar, nullable, firstSet,
+                                                                        grammar->startSymbol, grammar->endMarker, followSet);
+    }
+
+    // 构建LR(0)分析表（纯LR(0)，不使用FOLLOW集）
+    virtual void buildLR0ParseTable() {
+        // 清理之前的缓存数据
+        actionTable.clear();
+        gotoTable.clear();
+
+        buildItemSets();
+        allocateTables();
+
+        // 1. 处理移进和GOTO动作
+        fillShiftAndGotoActions();
+
+        // 2. 处理规约和接受动作（LR(0)方式）
+        for (size_t i = 0; i < automaton->itemSets.size(); i++) {
+            ItemSet itemSet = stateItems(static_cast<int>(i));
+
+            for (const auto& item : itemSet) {
+                const Production& prod = grammar->productions[item.prodIndex()];
+
+                // 点在末尾（规约项目）
+                if (static_cast<size_t>(item.dotPos()) == prod.right.size()) {
+                    // 接受项目：S' -> S·
+                    if (item.prodIndex() == grammar->augmentedProductionIndex) {
+                        action(static_cast<int>(i), grammar->endMarker) = makeAction(ACTION_ACCEPT);
+                    }
+                    // 规约项目 - LR(0)对所有终结符都添加规约动作
+                    else {
+                        uint32_t reduceAction = makeAction(ACTION_REDUCE, item.prodIndex());
+                        for (int term = 0; term < grammar->symbols.numTerminals; term++) {
+                            // LR(0)直接添加规约动作，可能产生冲突
+                            uint32_t& existingAction = action(static_cast<int>(i), term);
+                            if (actionKind(existingAction) != ACTION_ERROR) {
+                                // 报告冲突但继续执行
+                                cout << "LR(0) Conflict in state " << i << ", symbol " << grammar->symbols.name(term)
+                                     << ": " << actionToString(existingAction) << " vs " << actionToString(reduceAction) << endl;
+                            }
+                            existingAction = reduceAction;
+                        }
+                    }
                 }
-                items.push_back(itemStr);
             }
-            setJson["items"] = move(items);
-            itemSetJson.push_back(move(setJson));
-        }
-        result["item_sets"] = move(itemSetJson);
-        
-        // ACTION表
-        crow::json::wvalue actionJson;
-        for (const auto& [key, value] : actionTable) {
-            string state = to_string(key.first);
-            string symbol = key.second;
-            actionJson[state][symbol] = value;
-        }
-        result["action_table"] = move(actionJson);
-        
-        // GOTO表
-        crow::json::wvalue gotoJson;
-        for (const auto& [key, value] : gotoTable) {
-            string state = to_string(key.first);
-            string symbol = key.second;
-            gotoJson[state][symbol] = value;
-        }
-        result["goto_table"] = move(gotoJson);
-        
-        // 分析结果
-        result["parse_result"] = parseResult;
-        
-        // 分析步骤
-        vector<crow::json::wvalue> stepJson;
-        for (const auto& step : parseSteps) {
-            crow::json::wvalue s;
-            s["step"] = step.step;
-            s["state_stack"] = step.stateStack;
-            s["symbol_stack"] = step.symbolStack;
-            s["current_input"] = step.currentInput;
-            s["remaining_input"] = step.remainingInput;
-            s["action"] = step.action;
-            stepJson.push_back(move(s));
-        }
-        result["parse_steps"] = move(stepJson);
-        
-        return result;
-    }
+        }
+    }
+
+    // 构建SLR(1)分析表
+    virtual void buildSLR1ParseTable() {
+        // 清理之前的缓存数据
+        actionTable.clear();
+        gotoTable.clear();
+        firstSet.clear();
+        followSet.clear();
+        gotoTable.clear();
+
+        computeFirstSets();
+        computeFollowSets();
+        buildItemSets();
+        allocateTables();
+
+        // 1. 处理移进和GOTO动作
+        fillShiftAndGotoActions();
+
+        // 2. 处理规约和接受动作
+        for (size_t i = 0; i < automaton->itemSets.size(); i++) {
+            ItemSet itemSet = stateItems(static_cast<int>(i));
+
+            for (const auto& item : itemSet) {
+                const Production& prod = grammar->productions[item.prodIndex()];
+
+                // 点在末尾（规约项目）
+                if (static_cast<size_t>(item.dotPos()) == prod.right.size()) {
+                    // 接受项目：S' -> S·
+                    if (item.prodIndex() == grammar->augmentedProductionIndex) {
+                        action(static_cast<int>(i), grammar->endMarker) = makeAction(ACTION_ACCEPT);
+                    }
+                    // 规约项目 - SLR(1)使用FOLLOW集
+                    else {
+                        // 对该非终结符的FOLLOW集中的每个终结符添加规约动作
+                        const BitSet& follow = followSet[prod.left];
+                        follow.forEach([&](int term) {
+                            addReduceAction(static_cast<int>(i), term, item.prodIndex());
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    // 构建LALR(1)分析表：在LR(0)自动机上用DeRemer–Pennello方法计算向前看集合
+    // （不合并LR(1)状态，状态数与LR(0)/SLR(1)相同）
+    virtual void buildLALR1ParseTable() {
+        // 清理之前的缓存数据
+        actionTable.clear();
+        gotoTable.clear();
+        firstSet.clear();
+        followSet.clear();
+
+        computeFirstSets();   // 需要其中的可空性
+        buildItemSets();
+        allocateTables();
+
+        // 1. 处理移进和GOTO动作
+        fillShiftAndGotoActions();
+
+        // 转移查找：(状态, 符号) -> 目标状态；并为每条非终结符转移 (p, A) 编号
+        auto edgeKey = [](int state, int symbol) {
+            return (static_cast<uint64_t>(state) << 32) | static_cast<uint32_t>(symbol);
+        };
+        unordered_map<uint64_t, int> transitionTarget;
+        unordered_map<uint64_t, int> ntTransitionIndex;
+        vector<pair<int, int>> ntTransitions;  // (p, A)
+        for (size_t p = 0; p < automaton->itemSets.size(); p++) {
+            for (const auto& [symbol, target] : automaton->transitions[p]) {
+                transitionTarget[edgeKey(static_cast<int>(p), symbol)] = target;
+                if (grammar->symbols.isNonTerminal(symbol)) {
+                    ntTransitionIndex[edgeKey(static_cast<int>(p), symbol)] = static_cast<int>(ntTransitions.size());
+                    ntTransitions.push_back({ static_cast<int>(p), symbol });
+                }
+            }
+        }
+        int numNtTransitions = static_cast<int>(ntTransitions.size());
+
+        // 2. DR(p, A)：goto(p, A) 中可以直接移进的终结符
+        //    reads：(p, A) reads (r, C) 当 r = goto(p, A) 且 C 可空
+        vector<BitSet> lookaheads(numNtTransitions, BitSet(grammar->symbols.numTerminals));
+        vector<vector<int>> reads(numNtTransitions);
+        for (int x = 0; x < numNtTransitions; x++) {
+            auto [p, nt] = ntTransitions[x];
+            int r = transitionTarget[edgeKey(p, nt)];
+            for (const auto& [symbol, target] : automaton->transitions[r]) {
+                if (grammar->symbols.isTerminal(symbol)) {
+                    lookaheads[x].set(symbol);
+                } else if (nullable[symbol]) {
+                    reads[x].push_back(ntTransitionIndex[edgeKey(r, symbol)]);
+                }
+            }
+            // S' -> S·# ：开始符号的转移之后是结束符
+            if (p == 0 && nt == grammar->startSymbol) lookaheads[x].set(grammar->endMarker);
+        }
+
+        // Read(p, A) = DR(p, A) ∪ ⋃{ Read(r, C) | (p, A) reads (r, C) }
+        digraph(reads, lookaheads);
+
+        // 3. includes：(p', B) ⊇ ... 当 B -> β A γ，γ 可空，且 p' 经 β 到达 p，则 (p, A) includes (p', B)
+        //    lookback：(q, A -> ω) lookback (p, A) 当 p 经 ω 到达 q
+        vector<vector<int>> includes(numNtTransitions);
+        unordered_map<uint64_t, vector<int>> lookback;  // (q, 产生式) -> 非终结符转移
+        vector<int> path;
+        for (int x = 0; x < numNtTransitions; x++) {
+            auto [startState, left] = ntTransitions[x];
+            for (int prodIndex : grammar->productionsByLeft[left]) {
+                const vector<int>& right = grammar->productions[prodIndex].right;
+
+                // 沿产生式右部在自动机上行走，path[i] 为读入 right[i] 之前的状态
+                path.clear();
+                int state = startState;
+                for (int sym : right) {
+                    path.push_back(state);
+                    state = transitionTarget.at(edgeKey(state, sym));
+                }
+                lookback[edgeKey(state, prodIndex)].push_back(x);
+
+                // 从右向左，后缀可空的非终结符位置产生includes关系
+                for (int i = static_cast<int>(right.size()) - 1; i >= 0; i--) {
+                    int sym = right[i];
+                    if (grammar->symbols.isTerminal(sym)) break;
+                    includes[ntTransitionIndex[edgeKey(path[i], sym)]].push_back(x);
+                    if (!nullable[sym]) break;
+                }
+            }
+        }
+
+        // Follow(p, A) = Read(p, A) ∪ ⋃{ Follow(p', B) | (p, A) includes (p', B) }
+        digraph(includes, lookaheads);
+
+        // 4. 处理规约和接受动作：LA(q, A -> ω) = ⋃{ Follow(p, A) | (q, A -> ω) lookback (p, A) }
+        for (size_t i = 0; i < automaton->itemSets.size(); i++) {
+            ItemSet itemSet = stateItems(static_cast<int>(i));
+
+            for (const auto& item : itemSet) {
+                const Production& prod = grammar->productions[item.prodIndex()];
+                if (static_cast<size_t>(item.dotPos()) != prod.right.size()) continue;
+
+                // 接受项目：S' -> S·
+                if (item.prodIndex() == grammar->augmentedProductionIndex) {
+                    action(static_cast<int>(i), grammar->endMarker) = makeAction(ACTION_ACCEPT);
+                    continue;
+                }
+
+                BitSet la(grammar->symbols.numTerminals);
+                auto it = lookback.find(edgeKey(static_cast<int>(i), item.prodIndex()));
+                if (it != lookback.end()) {
+                    for (int x : it->second) la.unionWith(lookaheads[x]);
+                }
+                la.forEach([&](int term) {
+                    addReduceAction(static_cast<int>(i), term, item.prodIndex());
+                });
+            }
+        }
+    }
+
+    // 计算带向前看集合的LR(1)闭包
+    // kernel/kernelLas 为核心项目及其向前看集合，结果 items 有序，las[k] 为 items[k] 的向前看集合
+    // A -> α·Bβ, L 产生 B -> ·γ, FIRST(β) ∪ (β可空 ? L : ∅)，按工作表传播直到不再变化
+    void lr1Closure(const ItemSet& kernel, const vector<BitSet>& kernelLas,
+                    ItemSet& items, vector<BitSet>& las) const {
+        items = kernel;
+        las = kernelLas;
+        unordered_map<int, int> slotOfProduction;  // 点在开头的项目 -> 在items中的位置
+        for (size_t k = 0; k < items.size(); k++) {
+            if (items[k].dotPos() == 0) slotOfProduction[items[k].prodIndex()] = static_cast<int>(k);
+        }
+
+        vector<int> worklist;
+        vector<char> queued(items.size(), 1);
+        for (size_t k = 0; k < items.size(); k++) worklist.push_back(static_cast<int>(k));
+
+        while (!worklist.empty()) {
+            int k = worklist.back();
+            worklist.pop_back();
+            queued[k] = 0;
+
+            // 向前看集合为空的项目在规范LR(1)中并不存在，不参与展开
+            if (las[k].empty()) continue;
+
+            const Production& prod = grammar->productions[items[k].prodIndex()];
+            int dot = items[k].dotPos();
+            if (dot >= static_cast<int>(prod.right.size())) continue;
+            int nextSymbol = prod.right[dot];
+            if (grammar->symbols.isTerminal(nextSymbol)) continue;
+
+            // 生成的向前看集合：FIRST(β)，β可空时再并上当前项目的向前看
+            BitSet generated(grammar->symbols.numTerminals);
+            bool restNullable = true;
+            for (size_t j = dot + 1; j < prod.right.size(); j++) {
+                generated.unionWith(firstSet[prod.right[j]]);
+                if (!nullable[prod.right[j]]) {
+                    restNullable = false;
+                    break;
+                }
+            }
+            if (restNullable) generated.unionWith(las[k]);
+            if (generated.empty()) continue;  // 只有含无用符号的文法才会出现
+
+            for (int prodIndex : grammar->productionsByLeft[nextSymbol]) {
+                auto [it, inserted] = slotOfProduction.insert({ prodIndex, static_cast<int>(items.size()) });
+                if (inserted) {
+                    items.push_back(Item(prodIndex, 0));
+                    las.push_back(generated);
+                    queued.push_back(1);
+                    worklist.push_back(it->second);
+                } else if (las[it->second].unionWith(generated) && !queued[it->second]) {
+                    queued[it->second] = 1;
+                    worklist.push_back(it->second);
+                }
+            }
+        }
+
+        // 按项目排序，向前看集合随之重排
+        vector<int> order(items.size());
+        for (size_t k = 0; k < order.size(); k++) order[k] = static_cast<int>(k);
+        sort(order.begin(), order.end(), [&items](int a, int b) { return items[a] < items[b]; });
+        ItemSet sortedItems;
+        vector<BitSet> sortedLas;
+        sortedItems.reserve(order.size());
+        sortedLas.reserve(order.size());
+        for (int k : order) {
+            sortedItems.push_back(items[k]);
+            sortedLas.push_back(move(las[k]));
+        }
+        items = move(sortedItems);
+        las = move(sortedLas);
+    }
+
+    // 按转移符号对LR(1)闭包分组，得到每个后继的核心项目及其向前看集合（按符号名次排列）
+    struct LR1Successor {
+        int symbol;
+        ItemSet kernel;
+        vector<BitSet> lookaheads;
+    };
+
+    vector<LR1Successor> lr1SuccessorKernels(const ItemSet& items, const vector<BitSet>& las) const {
+        vector<pair<pair<int, Item>, int>> advanced;  // ((符号名次, 移动点后的项目), 来源位置)
+        for (size_t k = 0; k < items.size(); k++) {
+            const Production& prod = grammar->productions[items[k].prodIndex()];
+            if (items[k].dotPos() >= static_cast<int>(prod.right.size()) || las[k].empty()) continue;
+            int symbol = prod.right[items[k].dotPos()];
+            advanced.push_back({ { grammar->symbolRank[symbol], Item(items[k].prodIndex(), items[k].dotPos() + 1) }, static_cast<int>(k) });
+        }
+        sort(advanced.begin(), advanced.end());
+
+        vector<LR1Successor> result;
+        for (const auto& [key, source] : advanced) {
+            int symbol = grammar->symbolsByName[key.first];
+            if (result.empty() || result.back().symbol != symbol) {
+                result.push_back({ symbol, {}, {} });
+            }
+            result.back().kernel.push_back(key.second);
+            result.back().lookaheads.push_back(las[source]);
+        }
+        return result;
+    }
+
+    // Pager弱相容性：核心相同的两个状态可以合并，当且仅当对任意 i ≠ j，
+    // (L1[i] ∩ L2[j] ≠ ∅ 或 L2[i] ∩ L1[j] ≠ ∅) 蕴含 (L1[i] ∩ L1[j] ≠ ∅ 或 L2[i] ∩ L2[j] ≠ ∅)
+    // 满足时合并不会引入规范LR(1)中不存在的规约-规约冲突
+    bool weaklyCompatible(const vector<BitSet>& a, const vector<BitSet>& b) {
+        for (size_t i = 0; i < a.size(); i++) {
+            for (size_t j = i + 1; j < a.size(); j++) {
+                bool crossed = a[i].intersects(b[j]) || b[i].intersects(a[j]);
+                if (!crossed) continue;
+                if (!(a[i].intersects(a[j]) || b[i].intersects(b[j]))) return false;
+            }
+        }
+        return true;
+    }
+
+    // 构建LR(1)项目集族，按Pager弱相容性即时合并同核心状态（PGM算法）
+    // 结果写入 automaton->itemSets / kernelLookaheads / automaton->transitions，并统计合并数和建立的项目集数
+    void buildLR1ItemSets() {
+        auto built = make_shared<Automaton>();
+        vector<ItemSet>& itemSets = built->itemSets;
+        vector<vector<Transition>>& transitions = built->transitions;
+        kernelLookaheads.clear();
+        lr1StatesMerged = 0;
+        lr1ItemSetsBuilt = 0;
+
+        // 每个状态已见过的向前看集合组（指纹）：同一组再次到达不算合并，
+        // 不同的组（无论是否扩大了已有集合）在规范LR(1)中是另一个状态，计入合并数
+        vector<unordered_set<uint64_t>> seenLookaheads;
+        auto lookaheadFingerprint = [](const vector<BitSet>& las) {
+            uint64_t h = 1469598103934665603ULL;
+            for (const auto& la : las) {
+                for (uint64_t w : la.words) {
+                    h ^= w;
+                    h *= 1099511628211ULL;
+                }
+            }
+            return h;
+        };
+
+        unordered_map<uint64_t, vector<int>> coreIndex;  // 核心指纹 -> 同核心的状态
+        queue<int> unprocessedSets;
+        vector<char> queued;
+
+        auto enqueue = [&](int state) {
+            if (!queued[state]) {
+                queued[state] = 1;
+                unprocessedSets.push(state);
+            }
+        };
+
+        // 查找可合并的同核心状态，找不到时新建
+        auto findOrMergeState = [&](ItemSet&& kernel, vector<BitSet>&& las) {
+            vector<int>& bucket = coreIndex[itemSetFingerprint(kernel)];
+            for (int state : bucket) {
+                if (itemSets[state] != kernel || !weaklyCompatible(kernelLookaheads[state], las)) continue;
+                if (seenLookaheads[state].insert(lookaheadFingerprint(las)).second) lr1StatesMerged++;
+
+                // 合并向前看集合；变大时需要重新展开该状态以传播到后继
+                bool grown = false;
+                for (size_t k = 0; k < las.size(); k++) {
+                    if (kernelLookaheads[state][k].unionWith(las[k])) grown = true;
+                }
+                if (grown) enqueue(state);
+                return state;
+            }
+
+            int newIndex = static_cast<int>(itemSets.size());
+            seenLookaheads.push_back({ lookaheadFingerprint(las) });
+            itemSets.push_back(move(kernel));
+            kernelLookaheads.push_back(move(las));
+            transitions.emplace_back();
+            queued.push_back(0);
+            bucket.push_back(newIndex);
+            enqueue(newIndex);
+            lr1ItemSetsBuilt++;
+            return newIndex;
+        };
+
+        // 创建初始项目集 [S' -> ·S, #]
+        BitSet startLookahead(grammar->symbols.numTerminals);
+        startLookahead.set(grammar->endMarker);
+        findOrMergeState({ Item(grammar->augmentedProductionIndex, 0) }, { startLookahead });
+
+        ItemSet items;
+        vector<BitSet> las;
+        while (!unprocessedSets.empty()) {
+            int currentIndex = unprocessedSets.front();
+            unprocessedSets.pop();
+            queued[currentIndex] = 0;
+
+            // 重新展开时后继可能变化，出边整体重建
+            lr1Closure(itemSets[currentIndex], kernelLookaheads[currentIndex], items, las);
+            transitions[currentIndex].clear();
+            for (auto& successor : lr1SuccessorKernels(items, las)) {
+                int newIndex = findOrMergeState(move(successor.kernel), move(successor.lookaheads));
+                transitions[currentIndex].push_back({ successor.symbol, newIndex });
+            }
+        }
+
+        // 合并后重新展开可能让部分状态不再可达，其向前看集合也可能偏大：
+        // 在确定的转移结构上从初始状态重新传播一遍精确的向前看集合，再删除不可达状态
+        for (auto& stateLas : kernelLookaheads) {
+            for (auto& la : stateLas) la = BitSet(grammar->symbols.numTerminals);
+        }
+        kernelLookaheads[0][0].set(grammar->endMarker);
+        fill(queued.begin(), queued.end(), 0);
+        enqueue(0);
+        while (!unprocessedSets.empty()) {
+            int currentIndex = unprocessedSets.front();
+            unprocessedSets.pop();
+            queued[currentIndex] = 0;
+
+            // 向前看集合尚不完整时后继可能只是已有转移的子集，按符号和项目对齐
+            lr1Closure(itemSets[currentIndex], kernelLookaheads[currentIndex], items, las);
+            for (const auto& successor : lr1SuccessorKernels(items, las)) {
+                int target = -1;
+                for (const auto& edge : transitions[currentIndex]) {
+                    if (edge.symbol == successor.symbol) target = edge.target;
+                }
+
+                bool grown = false;
+                size_t pos = 0;
+                for (size_t k = 0; k < successor.kernel.size(); k++) {
+                    while (!(itemSets[target][pos] == successor.kernel[k])) pos++;
+                    if (kernelLookaheads[target][pos].unionWith(successor.lookaheads[k])) grown = true;
+                }
+                if (grown) enqueue(target);
+            }
+        }
+
+        // 按广度优先顺序对可达状态重新编号
+        vector<int> newIndexOf(itemSets.size(), -1);
+        vector<int> order = { 0 };
+        newIndexOf[0] = 0;
+        for (size_t k = 0; k < order.size(); k++) {
+            for (const auto& edge : transitions[order[k]]) {
+                if (newIndexOf[edge.target] < 0) {
+                    newIndexOf[edge.target] = static_cast<int>(order.size());
+                    order.push_back(edge.target);
+                }
+            }
+        }
+        vector<ItemSet> reachableSets;
+        vector<vector<BitSet>> reachableLas;
+        vector<vector<Transition>> reachableTransitions;
+        for (int state : order) {
+            reachableSets.push_back(move(itemSets[state]));
+            reachableLas.push_back(move(kernelLookaheads[state]));
+            for (auto& edge : transitions[state]) edge.target = newIndexOf[edge.target];
+            reachableTransitions.push_back(move(transitions[state]));
+        }
+        itemSets = move(reachableSets);
+        kernelLookaheads = move(reachableLas);
+        transitions = move(reachableTransitions);
+        automaton = built;
+    }
+
+    // 构建LR(1)分析表（Pager合并后的LR(1)自动机，状态数接近LALR(1)）
+    virtual void buildLR1ParseTable() {
+        // 清理之前的缓存数据
+        actionTable.clear();
+        gotoTable.clear();
+        firstSet.clear();
+        followSet.clear();
+
+        computeFirstSets();
+        buildLR1ItemSets();
+        allocateTables();
+
+        // 1. 处理移进和GOTO动作
+        fillShiftAndGotoActions();
+
+        // 2. 处理规约和接受动作：规约项目的向前看集合即为规约的终结符
+        ItemSet items;
+        vector<BitSet> las;
+        for (size_t i = 0; i < automaton->itemSets.size(); i++) {
+            lr1Closure(automaton->itemSets[i], kernelLookaheads[i], items, las);
+
+            for (size_t k = 0; k < items.size(); k++) {
+                const Production& prod = grammar->productions[items[k].prodIndex()];
+                if (static_cast<size_t>(items[k].dotPos()) != prod.right.size()) continue;
+
+                // 接受项目：[S' -> S·, #]
+                if (items[k].prodIndex() == grammar->augmentedProductionIndex) {
+                    action(static_cast<int>(i), grammar->endMarker) = makeAction(ACTION_ACCEPT);
+                    continue;
+                }
+
+                las[k].forEach([&](int term) {
+                    addReduceAction(static_cast<int>(i), term, items[k].prodIndex());
+                });
+            }
+        }
+    }
+
+    // 从输入加载文法
+    void loadGrammar(const vector<string>& lines) {
+        auto loaded = make_shared<Grammar>();
+        loaded->load(lines);
+        loadGrammar(loaded);
+    }
+
+    // 使用已加载的文法（与其他分析器共享），之前构造的自动机和分析表全部作废
+    void loadGrammar(shared_ptr<const Grammar> loaded) {
+        clearCache();
+        grammar = move(loaded);
+    }
+
+    // 将文法和分析表写成二进制格式（见CompiledHeader），withItemSets为true时附带核心项目
+    // 先写临时文件再改名，正在映射旧文件的进程不受影响
+    void saveCompiled(const string& path, bool withItemSets) const {
+        if (actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+
+        const SymbolTable& symbols = grammar->symbols;
+        const vector<Production>& productions = grammar->productions;
+        const vector<ItemSet>& itemSets = automaton->itemSets;
+
+        vector<char> buffer(sizeof(CompiledHeader), 0);
+        auto align = [&buffer]() { buffer.resize((buffer.size() + 7) / 8 * 8, 0); };
+        auto append = [&buffer](const void* data, size_t bytes) {
+            const char* p = static_cast<const char*>(data);
+            buffer.insert(buffer.end(), p, p + bytes);
+        };
+
+        CompiledHeader header = {};
+        memcpy(header.magic, COMPILED_MAGIC, sizeof(header.magic));
+        header.version = COMPILED_VERSION;
+        header.byteOrder = COMPILED_BYTE_ORDER;
+        header.kind = static_cast<uint32_t>(find(begin(PARSER_KINDS), end(PARSER_KINDS), kindName()) - begin(PARSER_KINDS));
+        header.flags = withItemSets ? COMPILED_HAS_ITEM_SETS : 0;
+        header.grammarHash = stringFingerprint(grammar->normalized());
+        header.numSymbols = symbols.size();
+        header.numTerminals = symbols.numTerminals;
+        header.numProductions = static_cast<int32_t>(productions.size());
+        header.numStates = static_cast<int32_t>(itemSets.size());
+        header.startSymbol = grammar->startSymbol;
+        header.endMarker = grammar->endMarker;
+        header.augmentedStartSymbol = grammar->augmentedStartSymbol;
+        header.augmentedProductionIndex = grammar->augmentedProductionIndex;
+
+        // 符号名
+        vector<uint32_t> nameOffsets = { 0 };
+        for (int id = 0; id < symbols.size(); id++) {
+            nameOffsets.push_back(nameOffsets.back() + static_cast<uint32_t>(symbols.name(id).size()));
+        }
+        header.symbolOffsetsAt = buffer.size();
+        append(nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t));
+        header.symbolNamesAt = buffer.size();
+        for (int id = 0; id < symbols.size(); id++) {
+            append(symbols.name(id).data(), symbols.name(id).size());
+        }
+        align();
+
+        // 产生式
+        vector<int32_t> lefts;
+        vector<uint32_t> rightOffsets = { 0 };
+        vector<int32_t> rights;
+        for (const auto& prod : productions) {
+            lefts.push_back(prod.left);
+            rights.insert(rights.end(), prod.right.begin(), prod.right.end());
+            rightOffsets.push_back(static_cast<uint32_t>(rights.size()));
+        }
+        header.prodLeftAt = buffer.size();
+        append(lefts.data(), lefts.size() * sizeof(int32_t));
+        align();
+        header.prodRightOffsetsAt = buffer.size();
+        append(rightOffsets.data(), rightOffsets.size() * sizeof(uint32_t));
+        align();
+        header.prodRightAt = buffer.size();
+        append(rights.data(), rights.size() * sizeof(int32_t));
+        align();
+
+        // ACTION/GOTO表
+        header.actionAt = buffer.size();
+        append(actionTable.data(), actionTable.size() * sizeof(uint32_t));
+        align();
+        header.gotoAt = buffer.size();
+        append(gotoTable.data(), gotoTable.size() * sizeof(int));
+        align();
+
+        // 核心项目
+        if (withItemSets) {
+            vector<uint64_t> kernelOffsets = { 0 };
+            for (const auto& kernel : itemSets) {
+                kernelOffsets.push_back(kernelOffsets.back() + kernel.size());
+            }
+            header.kernelOffsetsAt = buffer.size();
+            append(kernelOffsets.data(), kernelOffsets.size() * sizeof(uint64_t));
+            header.kernelItemsAt = buffer.size();
+            for (const auto& kernel : itemSets) {
+                for (const auto& item : kernel) append(&item.key, sizeof(uint64_t));
+            }
+        }
+
+        header.fileSize = buffer.size();
+        memcpy(buffer.data(), &header, sizeof(header));
+
+        string tmpPath = path + ".tmp";
+        {
+            ofstream out(tmpPath, ios::binary | ios::trunc);
+            if (!out) throw runtime_error("Cannot open '" + tmpPath + "' for writing");
+            out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+            if (!out) throw runtime_error("Error writing '" + tmpPath + "'");
+        }
+        filesystem::rename(tmpPath, path);
+    }
+
+    // 估算文法和分析表占用的内存字节数（用于编译缓存的预算）
+    size_t memoryUsage() const {
+        size_t bytes = sizeof(*this);
+        for (const auto& name : grammar->symbols.names) {
+            bytes += 2 * (sizeof(string) + name.size()) + 4 * sizeof(int);  // 名字表和哈希表各一份
+        }
+        for (const auto& prod : grammar->productions) {
+            bytes += sizeof(Production) + prod.right.size() * sizeof(int);
+        }
+        for (const auto& kernel : automaton->itemSets) {
+            bytes += sizeof(ItemSet) + kernel.size() * sizeof(Item);
+        }
+        for (const auto& edges : automaton->transitions) {
+            bytes += sizeof(edges) + edges.size() * sizeof(Transition);
+        }
+        for (const auto& las : kernelLookaheads) {
+            for (const auto& la : las) bytes += sizeof(BitSet) + la.words.size() * sizeof(uint64_t);
+        }
+        for (const auto& sets : { &firstSet, &followSet }) {
+            for (const auto& set : *sets) bytes += sizeof(BitSet) + set.words.size() * sizeof(uint64_t);
+        }
+        bytes += actionTable.size() * sizeof(uint32_t) + gotoTable.size() * sizeof(int);
+        return bytes;
+    }
+
+    // 语法分析过程（每步只向trace追加一条操作记录，不修改分析器本身）
+    bool parse(const string& input, ParseTrace& trace) const {
+        trace.id = nextTraceId++;
+        trace.ops.clear();
+        trace.tokens = Grammar::split(input, ' ');
+
+        // 将输入串转换为终结符ID，未知符号记为-1
+        trace.tokenIds.clear();
+        for (const auto& token : trace.tokens) {
+            int id = grammar->symbols.find(token);
+            trace.tokenIds.push_back(id >= 0 && grammar->symbols.isTerminal(id) ? id : -1);
+        }
+
+        vector<int> stateStack;   // 状态栈
+        stateStack.push_back(0);  // 初始状态
+
+        // 语法树：结点栈与状态栈同步，每次移进或规约只追加一个结点和它的子结点下标
+        ParseTree& tree = trace.tree;
+        tree.nodes.clear();
+        tree.children.clear();
+        tree.root = -1;
+        // 结点数 = 移进数 + 规约数，规约数取决于文法（单产生式链、ε产生式），没有只由输入长度决定的上界；
+        // 这里按每个符号约一次规约估计预留容量，超出时vector照常增长
+        tree.nodes.reserve(2 * trace.tokens.size() + 1);
+        tree.children.reserve(2 * trace.tokens.size());
+        vector<int> nodeStack = { -1 };
+
+        size_t inputPtr = 0;      // 输入指针
+
+        while (true) {
+            // 获取当前状态和输入符号
+            int currentState = stateStack.back();
+            int currentToken = (inputPtr < trace.tokens.size()) ? trace.tokenIds[inputPtr] : grammar->endMarker;
+
+            // 查找ACTION表（未知符号没有表项）
+            uint32_t act = currentToken >= 0 ? action(currentState, currentToken) : makeAction(ACTION_ERROR);
+            ParseOp op{act, -1, static_cast<int>(inputPtr)};
+
+            if (actionKind(act) == ACTION_ERROR) {
+                trace.ops.push_back(op);
+                trace.accepted = false;
+                return false;
+            }
+
+            // 处理动作
+            if (actionKind(act) == ACTION_ACCEPT) {
+                // 接受
+                trace.ops.push_back(op);
+                trace.accepted = true;
+                tree.root = nodeStack.back();
+                return true;
+            }
+            else if (actionKind(act) == ACTION_SHIFT) {
+                // 移进动作
+                stateStack.push_back(actionTarget(act));
+                int position = static_cast<int>(inputPtr);
+                tree.nodes.push_back({-1, currentToken, static_cast<int>(tree.children.size()), 0, position, position + 1});
+                nodeStack.push_back(static_cast<int>(tree.nodes.size()) - 1);
+                inputPtr++;
+            }
+            else if (actionKind(act) == ACTION_REDUCE) {
+                // 规约动作：弹出产生式右部（ε产生式不弹出任何符号）后查GOTO表
+                const Production& prod = grammar->productions[actionTarget(act)];
+                stateStack.resize(stateStack.size() - prod.right.size());
+                op.gotoTarget = gotoState(stateStack.back(), prod.left);
+                if (op.gotoTarget < 0) {
+                    trace.ops.push_back(op);
+                    trace.accepted = false;
+                    return false;
+                }
+                stateStack.push_back(op.gotoTarget);
+
+                // 子结点是结点栈顶的若干项，ε产生式的结点覆盖空区间
+                int count = static_cast<int>(prod.right.size());
+                int position = static_cast<int>(inputPtr);
+                ParseTree::Node node{static_cast<int>(actionTarget(act)), prod.left, static_cast<int>(tree.children.size()),
+                                     count, position, position};
+                if (count > 0) {
+                    node.tokenStart = tree.nodes[nodeStack[nodeStack.size() - count]].tokenStart;
+                    node.tokenEnd = tree.nodes[nodeStack.back()].tokenEnd;
+                }
+                tree.children.insert(tree.children.end(), nodeStack.end() - count, nodeStack.end());
+                nodeStack.resize(nodeStack.size() - count);
+                tree.nodes.push_back(node);
+                nodeStack.push_back(static_cast<int>(tree.nodes.size()) - 1);
+            }
+
+            trace.ops.push_back(op);
+        }
+    }
+
+    // 按窗口重建分析步骤 [from, from + count)，超出范围的部分被截掉
+    vector<ParseStep> parseStepsWindow(const ParseTrace& trace, size_t from, size_t count) const {
+        vector<ParseStep> steps;
+        if (from >= trace.ops.size()) return steps;
+        size_t end = from + min(count, trace.ops.size() - from);
+
+        // 检查点在第一次读取窗口时通过一遍重放建立
+        call_once(trace.checkpointsBuilt, [&]() { buildTraceCheckpoints(trace); });
+
+        // 从最近的检查点恢复栈，再重放到窗口起点
+        size_t checkpoint = from / TRACE_CHECKPOINT_INTERVAL;
+        vector<int> stateStack, symbolStack;
+        for (int node = trace.checkpoints[checkpoint]; node >= 0; node = trace.stackNodes[node].parent) {
+            stateStack.push_back(trace.stackNodes[node].state);
+            symbolStack.push_back(trace.stackNodes[node].symbol);
+        }
+        reverse(stateStack.begin(), stateStack.end());
+        reverse(symbolStack.begin(), symbolStack.end());
+        for (size_t i = checkpoint * TRACE_CHECKPOINT_INTERVAL; i < from; i++) {
+            applyParseOp(trace, trace.ops[i], stateStack, symbolStack);
+        }
+
+        for (size_t i = from; i < end; i++) {
+            steps.push_back(describeParseStep(trace, i, stateStack, symbolStack));
+            applyParseOp(trace, trace.ops[i], stateStack, symbolStack);
+        }
+        return steps;
+    }
+
+    // 将分析步骤转换为Crow JSON格式
+    static crow::json::wvalue toJson(const vector<ParseStep>& steps) {
+        vector<crow::json::wvalue> stepJson;
+        for (const auto& step : steps) {
+            crow::json::wvalue s;
+            s["step"] = step.step;
+            s["state_stack"] = step.stateStack;
+            s["symbol_stack"] = step.symbolStack;
+            s["current_input"] = step.currentInput;
+            s["remaining_input"] = step.remainingInput;
+            s["action"] = step.action;
+            stepJson.push_back(move(s));
+        }
+        return crow::json::wvalue(move(stepJson));
+    }
+
+    // 仅识别的语法分析：边扫描边查表，只维护状态栈，不生成任何中间字符串，
+    // 时间和内存都与输入长度成线性，适合很长的符号串
+    RecognizeResult recognize(const string& input) const {
+        if (actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+        return recognizeWith(*this, input);
+    }
+
+    // 只输出规约序列的分析：按顺序记录每次规约的产生式ID（即最右推导的逆序），客户端据此重放语义动作
+    RecognizeResult reductions(const string& input, vector<int>& sequence) const {
+        if (actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+        return reductionsWith(*this, input, sequence);
+    }
+
+    template <typename Tables>
+    static RecognizeResult reductionsWith(const Tables& tables, const string& input, vector<int>& sequence) {
+        PushParser<Tables> parser(tables);
+        parser.logReductions(&sequence);
+        parser.feedText(input);
+        return parser.finish();
+    }
+
+    // 一次送入整个输入的推送式识别，Tables为提供分析表查询的类型（ParserBase或映射文件上的TableView），
+    // 需要 terminalId / endMarkerId / action / gotoState / productionLength / productionLeft
+    template <typename Tables>
+    static RecognizeResult recognizeWith(const Tables& tables, const string& input) {
+        PushParser<Tables> parser(tables);
+        parser.feedText(input);
+        return parser.finish();
+    }
+
+    // 批量识别：工作线程池中的线程共享只读的分析表，通过原子下标领取下一个输入
+    vector<RecognizeResult> recognizeBatch(const vector<string>& inputs, WorkerPool& pool) const {
+        if (actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+
+        vector<RecognizeResult> results(inputs.size());
+        pool.run(inputs.size(), [&](size_t i) {
+            results[i] = recognize(inputs[i]);
+        });
+        return results;
+    }
+
+    // 语法树的扁平后序表示：每个结点依次为 产生式ID（终结符为-1）、直接子结点数、覆盖的输入符号区间起止，
+    // 子结点总在父结点之前，客户端用一个栈即可还原整棵树
+    static const int TREE_NODE_FIELDS = 4;
+
+    static vector<int> flatTree(const ParseTree& tree) {
+        vector<int> flat;
+        if (tree.root >= 0) {
+            flat.reserve(tree.nodes.size() * TREE_NODE_FIELDS);
+            for (const auto& node : tree.nodes) {
+                flat.insert(flat.end(), { node.production, node.childCount, node.tokenStart, node.tokenEnd });
+            }
+        }
+        return flat;
+    }
+
+    static crow::json::wvalue toJson(const ParseTree& tree) {
+        crow::json::wvalue json;
+        json = flatTree(tree);
+        return json;
+    }
+
+    // 将仅识别模式的结果转换为Crow JSON格式
+    static crow::json::wvalue toJson(const RecognizeResult& recognized) {
+        crow::json::wvalue result;
+        result["parse_result"] = recognized.accepted;
+        result["error_position"] = recognized.errorPosition;
+        result["step_count"] = recognized.steps;
+        return result;
+    }
+
+    // 分析结果的输出形式：steps为完整的分析步骤；reductions为规约序列的整数数组；
+    // reductions_base64为规约序列按小端int32打包后的Base64
+    static bool isOutputMode(const string& output) {
+        return output == "steps" || output == "reductions" || output == "reductions_base64";
+    }
+
+    static crow::json::wvalue toJson(const RecognizeResult& recognized, const vector<int>& sequence, bool base64) {
+        crow::json::wvalue result = toJson(recognized);
+        result["reduction_count"] = static_cast<int>(sequence.size());
+        if (!base64) {
+            result["reductions"] = sequence;
+            return result;
+        }
+        result["reductions_base64"] = base64Encode(packInt32(sequence));
+        return result;
+    }
+
+    // 按小端int32打包整数序列（reductions_base64编码前的字节）
+    static string packInt32(const vector<int>& sequence) {
+        string bytes(sequence.size() * 4, '\0');
+        for (size_t i = 0; i < sequence.size(); i++) {
+            uint32_t value = static_cast<uint32_t>(sequence[i]);
+            for (int b = 0; b < 4; b++) bytes[i * 4 + b] = static_cast<char>((value >> (8 * b)) & 0xff);
+        }
+        return bytes;
+    }
+
+    // 将内部数据转换为Crow JSON格式；trace为空时分析结果为false、步骤为空
+    crow::json::wvalue toJson(const ParseTrace* trace = nullptr, bool withSteps = true) const {
+        crow::json::wvalue result;
+
+        // 文法信息
+        result["start_symbol"] = grammar->startSymbol >= 0 ? grammar->symbols.name(grammar->startSymbol) : "";
+        result["augmented_start_symbol"] = grammar->augmentedStartSymbol >= 0 ? grammar->symbols.name(grammar->augmentedStartSymbol) : "";
+
+        // 非终结符
+        vector<string> ntVec;
+        for (int id = grammar->symbols.numTerminals; id < grammar->symbols.size(); id++) {
+            ntVec.push_back(grammar->symbols.name(id));
+        }
+        result["non_terminals"] = ntVec;
+
+        // 终结符
+        vector<string> tVec;
+        for (int id = 0; id < grammar->symbols.numTerminals; id++) {
+            tVec.push_back(grammar->symbols.name(id));
+        }
+        result["terminals"] = tVec;
+
+        // 产生式
+        vector<string> prodStrs;
+        for (size_t i = 0; i < grammar->productions.size(); i++) {
+            prodStrs.push_back(to_string(i) + ": " + productionToString(grammar->productions[i]));
+        }
+        result["productions"] = prodStrs;
+
+        // FIRST集
+        crow::json::wvalue firstJson;
+        for (size_t id = 0; id < firstSet.size(); id++) {
+            if (static_cast<int>(id) == grammar->augmentedStartSymbol) continue;
+            firstJson[grammar->symbols.name(id)] = terminalSetToStrings(firstSet[id], nullable[id]);
+        }
+        result["first_set"] = move(firstJson);
+
+        // FOLLOW集
+        crow::json::wvalue followJson;
+        for (int id = grammar->symbols.numTerminals; id < static_cast<int>(followSet.size()); id++) {
+            if (id == grammar->augmentedStartSymbol) continue;
+            followJson[grammar->symbols.name(id)] = terminalSetToStrings(followSet[id], false);
+        }
+        result["follow_set"] = move(followJson);
+
+        // 项目集族（LR(1)项目在末尾附带向前看集合，如 "A -> a . B , a/b"）
+        vector<crow::json::wvalue> itemSetJson;
+        ItemSet closureItems;
+        vector<BitSet> closureLas;
+        for (size_t i = 0; i < automaton->itemSets.size(); i++) {
+            crow::json::wvalue setJson;
+            setJson["state"] = static_cast<int>(i);
+
+            if (kernelLookaheads.empty()) {
+                closureItems = stateItems(static_cast<int>(i));
+            } else {
+                lr1Closure(automaton->itemSets[i], kernelLookaheads[i], closureItems, closureLas);
+            }
+
+            vector<string> items;
+            for (size_t k = 0; k < closureItems.size(); k++) {
+                const Item& item = closureItems[k];
+                const Production& prod = grammar->productions[item.prodIndex()];
+                string itemStr = grammar->symbols.name(prod.left) + " -> ";
+
+                for (size_t j = 0; j < prod.right.size(); j++) {
+                    if (static_cast<int>(j) == item.dotPos()) itemStr += ". ";
+                    itemStr += grammar->symbols.name(prod.right[j]) + " ";
+                }
+
+                if (item.dotPos() == static_cast<int>(prod.right.size())) {
+                    itemStr += ".";
+                }
+                if (!kernelLookaheads.empty()) {
+                    string la;
+                    for (const auto& term : terminalSetToStrings(closureLas[k], false)) {
+                        la += (la.empty() ? "" : "/") + term;
+                    }
+                    itemStr += " , " + la;
+                }
+                items.push_back(itemStr);
+            }
+            setJson["items"] = move(items);
+            itemSetJson.push_back(move(setJson));
+        }
+        result["item_sets"] = move(itemSetJson);
+
+        // ACTION表（仅在序列化时生成 "s12" / "r3" / "acc" 字符串）
+        crow::json::wvalue actionJson;
+        int numTableStates = grammar->symbols.numTerminals > 0 ? static_cast<int>(actionTable.size() / grammar->symbols.numTerminals) : 0;
+        for (int state = 0; state < numTableStates; state++) {
+            for (int term = 0; term < grammar->symbols.numTerminals; term++) {
+                uint32_t act = action(state, term);
+                if (actionKind(act) == ACTION_ERROR) continue;
+                actionJson[to_string(state)][grammar->symbols.name(term)] = actionToString(act);
+            }
+        }
+        result["action_table"] = move(actionJson);
+
+        // GOTO表
+        crow::json::wvalue gotoJson;
+        for (int state = 0; state < numTableStates; state++) {
+            for (int nt = grammar->symbols.numTerminals; nt < grammar->symbols.size(); nt++) {
+                int target = gotoState(state, nt);
+                if (target < 0) continue;
+                gotoJson[to_string(state)][grammar->symbols.name(nt)] = target;
+            }
+        }
+        result["goto_table"] = move(gotoJson);
+
+        // LR(1)构造统计
+        if (!kernelLookaheads.empty()) {
+            crow::json::wvalue stats;
+            stats["states"] = static_cast<int>(automaton->itemSets.size());
+            stats["states_merged"] = lr1StatesMerged;
+            stats["item_sets_built"] = lr1ItemSetsBuilt;
+            // 不合并时的状态数：建立的项目集加上并入它们的不同向前看集合组
+            stats["states_without_merging"] = lr1ItemSetsBuilt + lr1StatesMerged;
+            result["lr1_stats"] = move(stats);
+        }
+
+        // 分析结果
+        result["parse_result"] = trace ? trace->accepted : false;
+        if (trace && trace->accepted) result["parse_tree"] = toJson(trace->tree);
+
+        // 分析步骤（由操作日志重放得到栈内容）；withSteps为false时改由 /api/parse_steps 按窗口读取
+        if (withSteps) {
+            vector<ParseStep> steps;
+            vector<int> stateStack = {0};
+            vector<int> symbolStack = {grammar->endMarker};
+            for (size_t i = 0; trace && i < trace->ops.size(); i++) {
+                steps.push_back(describeParseStep(*trace, i, stateStack, symbolStack));
+                applyParseOp(*trace, trace->ops[i], stateStack, symbolStack);
+            }
+            result["parse_steps"] = toJson(steps);
+        }
+
+        return result;
+    }
+
+private:
+    // 辅助函数：根据第index步开始时的栈内容生成该步的完整描述
+    ParseStep describeParseStep(const ParseTrace& trace, size_t index,
+                                const vector<int>& stateStack, const vector<int>& symbolStack) const {
+        const ParseOp& op = trace.ops[index];
+        ParseStep ps;
+        ps.step = static_cast<int>(index) + 1;
+        ps.stateStack = stackToString(stateStack);
+        ps.symbolStack = symbolStackToString(symbolStack);
+        ps.currentInput = (op.inputPos < static_cast<int>(trace.tokens.size())) ? trace.tokens[op.inputPos] : "#";
+        ps.remainingInput = getRemainingInput(trace.tokens, op.inputPos);
+
+        switch (actionKind(op.action)) {
+        case ACTION_SHIFT:
+            ps.action = "Shift to state " + to_string(actionTarget(op.action));
+            break;
+        case ACTION_REDUCE:
+            ps.action = op.gotoTarget < 0 ? "Error: No GOTO entry"
+                                          : "Reduce: " + productionToString(grammar->productions[actionTarget(op.action)]);
+            break;
+        case ACTION_ACCEPT:
+            ps.action = "Accept";
+            break;
+        default:
+            ps.action = "Error: No ACTION entry";
+            break;
+        }
+        return ps;
+    }
+
+    // 辅助函数：重放整个操作日志，建立共享前缀的栈节点和检查点
+    void buildTraceCheckpoints(const ParseTrace& trace) const {
+        auto& nodes = trace.stackNodes;
+        nodes.clear();
+        trace.checkpoints.clear();
+        nodes.push_back({0, grammar->endMarker, -1});
+        int top = 0;
+        for (size_t i = 0; i < trace.ops.size(); i++) {
+            if (i % TRACE_CHECKPOINT_INTERVAL == 0) trace.checkpoints.push_back(top);
+
+            const ParseOp& op = trace.ops[i];
+            if (actionKind(op.action) == ACTION_SHIFT) {
+                nodes.push_back({static_cast<int>(actionTarget(op.action)), trace.tokenIds[op.inputPos], top});
+                top = static_cast<int>(nodes.size()) - 1;
+            }
+            else if (actionKind(op.action) == ACTION_REDUCE && op.gotoTarget >= 0) {
+                const Production& prod = grammar->productions[actionTarget(op.action)];
+                for (size_t k = 0; k < prod.right.size(); k++) top = nodes[top].parent;
+                nodes.push_back({op.gotoTarget, prod.left, top});
+                top = static_cast<int>(nodes.size()) - 1;
+            }
+        }
+    }
+
+    // 辅助函数：在栈上重放一步操作
+    void applyParseOp(const ParseTrace& trace, const ParseOp& op,
+                      vector<int>& stateStack, vector<int>& symbolStack) const {
+        if (actionKind(op.action) == ACTION_SHIFT) {
+            stateStack.push_back(actionTarget(op.action));
+            symbolStack.push_back(trace.tokenIds[op.inputPos]);
+        }
+        else if (actionKind(op.action) == ACTION_REDUCE && op.gotoTarget >= 0) {
+            const Production& prod = grammar->productions[actionTarget(op.action)];
+            stateStack.resize(stateStack.size() - prod.right.size());
+            symbolStack.resize(symbolStack.size() - prod.right.size());
+            stateStack.push_back(op.gotoTarget);
+            symbolStack.push_back(prod.left);
+        }
+    }
+
+    // 辅助函数：产生式转为字符串，如 "E -> E + T "
+    string productionToString(const Production& prod) const {
+        string result = grammar->symbols.name(prod.left) + " -> ";
+        if (prod.isEpsilon()) return result + "ε ";
+        for (int sym : prod.right) {
+            result += grammar->symbols.name(sym) + " ";
+        }
+        return result;
+    }
+
+    // 辅助函数：终结符ID集合转为按名字排序的字符串列表
+    vector<string> terminalSetToStrings(const BitSet& terms, bool withEpsilon) const {
+        vector<string> vals;
+        terms.forEach([&](int t) {
+            vals.push_back(grammar->symbols.name(t));
+        });
+        if (withEpsilon) vals.push_back("ε");
+        sort(vals.begin(), vals.end());
+        return vals;
+    }
+
+    // 辅助函数：将栈转为字符串（状态栈）
+    string stackToString(const vector<int>& stk) const {
+        string result;
+        for (int state : stk) {
+            result += to_string(state) + " ";
+        }
+        return result;
+    }
+
+    // 辅助函数：将栈转为字符串（符号栈）
+    string symbolStackToString(const vector<int>& stk) const {
+        string result;
+        for (int sym : stk) {
+            result += grammar->symbols.name(sym) + " ";
+        }
+        return result;
+    }
+
+    // 辅助函数：获取剩余输入字符串
+    string getRemainingInput(const vector<string>& tokens, size_t pos) const {
+        string result;
+        for (size_t i = pos; i < tokens.size(); ++i) {
+            result += tokens[i];
+            if (i < tokens.size() - 1) result += " ";
+        }
+        return result;
+    }
+};
+
+// LR(0)语法分析器类
+class LR0Parser : public ParserBase {
+public:
+    void buildParseTable() {
+        buildLR0ParseTable();
+    }
+
+    shared_ptr<ParserBase> clone() const {
+        return make_shared<LR0Parser>(*this);
+    }
+
+    string kindName() const {
+        return "lr0";
+    }
+};
+
+// SLR(1)语法分析器类  
+class SLR1Parser : public ParserBase {
+public:
+    void buildParseTable() {
+        buildSLR1ParseTable();
+    }
+
+    shared_ptr<ParserBase> clone() const {
+        return make_shared<SLR1Parser>(*this);
+    }
+
+    string kindName() const {
+        return "slr1";
+    }
+};
+
+// LALR(1)语法分析器类
+class LALR1Parser : public ParserBase {
+public:
+    void buildParseTable() {
+        buildLALR1ParseTable();
+    }
+
+    shared_ptr<ParserBase> clone() const {
+        return make_shared<LALR1Parser>(*this);
+    }
+
+    string kindName() const {
+        return "lalr1";
+    }
+};
+
+// LR(1)语法分析器类（Pager弱相容性合并）
+class LR1Parser : public ParserBase {
+public:
+    void buildParseTable() {
+        buildLR1ParseTable();
+    }
+
+    shared_ptr<ParserBase> clone() const {
+        return make_shared<LR1Parser>(*this);
+    }
+
+    string kindName() const {
+        return "lr1";
+    }
+};
+
+// GLR语法分析器：LALR(1)分析表中保留全部冲突动作，用图结构栈（GSS）同时推进所有可能的分析，
+// 并构造共享压缩分析森林（SPPF）。没有冲突的表项与LALR(1)相同，确定性的输入上始终只有一个栈顶
+class GLRParser : public LALR1Parser {
+public:
+    // 冲突表项的全部动作（键为 状态 × 终结符数 + 终结符），actionTable中只保留第一个动作
+    unordered_map<size_t, vector<uint32_t>> conflictActions;
+    BitSet conflictCells;   // 有冲突的表项
+
+    // 共享压缩分析森林：符号结点覆盖输入符号区间 [start, end)，每个打包结点是该符号的一种推导
+    struct Forest {
+        struct Node {
+            int symbol;
+            int start;
+            int end;
+            int firstPacked;     // 打包结点链表，终结符结点为-1
+        };
+        struct Packed {
+            int production;
+            int firstChild;      // 子结点在children中的起始下标
+            int numChildren;
+            int next;
+        };
+        vector<Node> nodes;
+        vector<Packed> packed;
+        vector<int> children;
+        int root = -1;
+    };
+
+    struct GLRResult {
+        bool accepted = false;
+        int errorPosition = -1;   // 出错时所在输入符号的下标，接受时为-1
+        vector<string> tokens;
+        Forest forest;
+        int gssNodes = 0;         // 创建的GSS结点数
+        int maxFrontier = 0;      // 同一层栈顶数的最大值
+    };
+
+    void buildParseTable() {
+        conflictActions.clear();
+        buildLALR1ParseTable();
+        conflictCells = BitSet(static_cast<int>(actionTable.size()));
+        for (const auto& entry : conflictActions) conflictCells.set(static_cast<int>(entry.first));
+    }
+
+    shared_ptr<ParserBase> clone() const {
+        return make_shared<GLRParser>(*this);
+    }
+
+    string kindName() const {
+        return "glr";
+    }
+
+    // 保留冲突：表项已有动作时把两者都记入conflictActions
+    void addReduceAction(int state, int term, int prodIndex) {
+        uint32_t& existingAction = action(state, term);
+        uint32_t reduceAction = makeAction(ACTION_REDUCE, prodIndex);
+        if (actionKind(existingAction) == ACTION_ERROR) {
+            existingAction = reduceAction;
+            return;
+        }
+        vector<uint32_t>& all = conflictActions[static_cast<size_t>(state) * grammar->symbols.numTerminals + term];
+        if (all.empty()) all.push_back(existingAction);
+        if (find(all.begin(), all.end(), reduceAction) == all.end()) all.push_back(reduceAction);
+    }
+
+    // GLR分析（Tomita算法，按Farshi的方法处理ε规约）：逐个输入符号推进GSS的一层，
+    // 先做完当前层的全部规约，再由所有能移进的栈顶移进到下一层；buildForest为false时只做识别，
+    // deterministic为false时不使用下面的确定性模式，全程在GSS上分析（结果相同，用于对照）
+    GLRResult glrParse(const string& input, bool buildForest = true, bool deterministic = true) const {
+        if (actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+
+        GLRResult result;
+        result.tokens = Grammar::split(input, ' ');
+        Forest& forest = result.forest;
+        const int numStates = static_cast<int>(automaton->itemSets.size());
+        const int numTerminals = grammar->symbols.numTerminals;
+
+        vector<GssNode> nodes;
+        vector<GssEdge> edges;
+        vector<int> frontier;                       // 当前层的结点
+        vector<int> nodeAtState(numStates, -1);     // 当前层 状态 -> 结点（以levelOf判断是否属于当前层）
+        vector<int> levelOf(numStates, -1);
+        vector<Reduction> pending;                  // 待做的规约
+        vector<pair<uint64_t, int>> levelSymbols;   // 当前层的SPPF符号结点：(符号, 起点) -> 结点
+        bool innerEdges = false;                    // 当前层是否有层内的边（来自ε规约）
+        int level = 0;
+        int token = -1;
+
+        auto forEachAction = [&](int state, auto f) {
+            if (token < 0) return;
+            size_t cell = static_cast<size_t>(state) * numTerminals + token;
+            if (conflictCells.test(static_cast<int>(cell))) {
+                for (uint32_t act : conflictActions.at(cell)) f(act);
+            } else if (actionKind(actionTable[cell]) != ACTION_ERROR) {
+                f(actionTable[cell]);
+            }
+        };
+
+        // 登记结点上的规约：edge为-1时是ε规约，否则是以edge为第一条边的规约
+        auto queueReductions = [&](int node, int edge) {
+            forEachAction(nodes[node].state, [&](uint32_t act) {
+                if (actionKind(act) != ACTION_REDUCE) return;
+                int prodIndex = actionTarget(act);
+                if (grammar->productions[prodIndex].right.empty() == (edge < 0)) {
+                    pending.push_back({ node, edge, prodIndex, -1 });
+                }
+            });
+        };
+
+        auto findNode = [&](int state) {
+            return levelOf[state] == level ? nodeAtState[state] : -1;
+        };
+
+        auto addNode = [&](int state) {
+            int node = static_cast<int>(nodes.size());
+            nodes.push_back({ state, level, -1 });
+            nodeAtState[state] = node;
+            levelOf[state] = level;
+            frontier.push_back(node);
+            queueReductions(node, -1);
+            return node;
+        };
+
+        auto addEdge = [&](int from, int to, int label) {
+            int edge = static_cast<int>(edges.size());
+            edges.push_back({ to, label, nodes[from].firstEdge });
+            nodes[from].firstEdge = edge;
+            if (nodes[to].level == level) innerEdges = true;
+            return edge;
+        };
+
+        // 当前层的符号结点 (symbol, start, level)，不存在时新建
+        auto symbolNode = [&](int symbol, int start) {
+            uint64_t key = (static_cast<uint64_t>(symbol) << 32) | static_cast<uint32_t>(start);
+            for (const auto& [k, node] : levelSymbols) {
+                if (k == key) return node;
+            }
+            int node = static_cast<int>(forest.nodes.size());
+            forest.nodes.push_back({ symbol, start, level, -1 });
+            levelSymbols.push_back({ key, node });
+            return node;
+        };
+
+        // 给符号结点加一种推导（已有相同推导时忽略）
+        auto addPacked = [&](int node, int prodIndex, const vector<int>& kids) {
+            for (int p = forest.nodes[node].firstPacked; p >= 0; p = forest.packed[p].next) {
+                const Forest::Packed& existing = forest.packed[p];
+                if (existing.production == prodIndex &&
+                    equal(kids.begin(), kids.end(), forest.children.begin() + existing.firstChild,
+                          forest.children.begin() + existing.firstChild + existing.numChildren)) {
+                    return;
+                }
+            }
+            forest.packed.push_back({ prodIndex, static_cast<int>(forest.children.size()),
+                                      static_cast<int>(kids.size()), forest.nodes[node].firstPacked });
+            forest.children.insert(forest.children.end(), kids.begin(), kids.end());
+            forest.nodes[node].firstPacked = static_cast<int>(forest.packed.size()) - 1;
+        };
+
+        // 沿路径规约到结点target：经GOTO得到新栈顶，新建结点或给已有结点加边
+        auto reduceTo = [&](int target, int prodIndex, const vector<int>& kids) {
+            int left = grammar->productions[prodIndex].left;
+            int nextState = gotoState(nodes[target].state, left);
+            if (nextState < 0) return;
+
+            int label = -1;
+            if (buildForest) {
+                label = symbolNode(left, nodes[target].level);
+                addPacked(label, prodIndex, kids);
+            }
+
+            int node = findNode(nextState);
+            if (node < 0) {
+                node = addNode(nextState);
+                queueReductions(node, addEdge(node, target, label));
+                return;
+            }
+            for (int e = nodes[node].firstEdge; e >= 0; e = edges[e].next) {
+                if (edges[e].target == target) return;   // 边已存在，其标记就是同一个符号结点
+            }
+
+            // 已有结点上的新边：经过这条边的规约路径都要重新做
+            int edge = addEdge(node, target, label);
+            queueReductions(node, edge);
+            if (innerEdges) {
+                for (int x : frontier) {
+                    forEachAction(nodes[x].state, [&](uint32_t act) {
+                        if (actionKind(act) == ACTION_REDUCE && grammar->productions[actionTarget(act)].right.size() >= 2) {
+                            pending.push_back({ x, -1, actionTarget(act), edge });
+                        }
+                    });
+                }
+            }
+        };
+
+        vector<int> tokenIds;
+        for (const auto& name : result.tokens) {
+            int id = grammar->symbols.find(name);
+            tokenIds.push_back(id >= 0 && grammar->symbols.isTerminal(id) ? id : -1);
+        }
+
+        token = tokenIds.empty() ? grammar->endMarker : tokenIds[0];
+        int root = addNode(0);
+        vector<int> kids;
+        vector<pair<int, int>> shifts;   // (栈顶结点, 目标状态)
+
+        // 移进当前输入符号：建立终结符结点并进入下一层，返回该结点
+        auto advance = [&] {
+            int leaf = -1;
+            if (buildForest) {
+                leaf = static_cast<int>(forest.nodes.size());
+                forest.nodes.push_back({ token, level, level + 1, -1 });
+            }
+            level++;
+            token = level < static_cast<int>(tokenIds.size()) ? tokenIds[level] : grammar->endMarker;
+            levelSymbols.clear();
+            innerEdges = false;
+            return leaf;
+        };
+
+        // 确定性模式：只有一个栈顶且表项无冲突时，在base之上的普通栈里按LR方式分析，不建GSS结点；
+        // 遇到冲突、规约超出普通栈、接受或出错时，把普通栈转成GSS结点链，回到GLR模式；
+        // 同一层再次进入某个状态时（循环文法）也回到GLR模式，由结点合并保证终止
+        struct StackEntry {
+            int state;
+            int level;
+            int label;
+        };
+        int base = -1;
+        vector<StackEntry> stack;
+        vector<int> visitedLevel(numStates, -1);   // 确定性模式下各状态最近一次进入的层
+
+        auto materialize = [&] {
+            frontier.clear();
+            if (nodes[base].level == level) frontier.push_back(base);
+            int top = base;
+            for (const StackEntry& entry : stack) {
+                int node = static_cast<int>(nodes.size());
+                nodes.push_back({ entry.state, entry.level, -1 });
+                addEdge(node, top, entry.label);
+                if (entry.level == level) {
+                    nodeAtState[entry.state] = node;
+                    levelOf[entry.state] = level;
+                    frontier.push_back(node);
+                }
+                top = node;
+            }
+            // 栈顶的动作尚未执行，其余结点的动作在确定性模式下已经做完
+            queueReductions(top, -1);
+            for (int e = nodes[top].firstEdge; e >= 0; e = edges[e].next) queueReductions(top, e);
+            base = -1;
+            stack.clear();
+        };
+
+        while (true) {
+            result.maxFrontier = max(result.maxFrontier, static_cast<int>(frontier.size()));
+            if (deterministic && base < 0 && frontier.size() == 1) {
+                base = frontier[0];
+                visitedLevel[nodes[base].state] = level;
+                pending.clear();
+            }
+            while (base >= 0) {
+                int state = stack.empty() ? nodes[base].state : stack.back().state;
+                size_t cell = static_cast<size_t>(state) * numTerminals + token;
+                if (token < 0 || conflictCells.test(static_cast<int>(cell))) {
+                    materialize();
+                    break;
+                }
+                uint32_t act = actionTable[cell];
+                if (actionKind(act) == ACTION_SHIFT) {
+                    int leaf = advance();
+                    stack.push_back({ actionTarget(act), level, leaf });
+                    visitedLevel[actionTarget(act)] = level;
+                    continue;
+                }
+                int prodIndex = actionTarget(act);
+                int length = static_cast<int>(grammar->productions[prodIndex].right.size());
+                if (actionKind(act) != ACTION_REDUCE || length > static_cast<int>(stack.size())) {
+                    materialize();
+                    break;
+                }
+
+                int below = static_cast<int>(stack.size()) - length - 1;
+                int targetState = below < 0 ? nodes[base].state : stack[below].state;
+                int targetLevel = below < 0 ? nodes[base].level : stack[below].level;
+                int left = grammar->productions[prodIndex].left;
+                int nextState = gotoState(targetState, left);
+                if (visitedLevel[nextState] == level) {
+                    materialize();
+                    break;
+                }
+                visitedLevel[nextState] = level;
+
+                int label = -1;
+                if (buildForest) {
+                    kids.resize(length);
+                    for (int i = 0; i < length; i++) kids[i] = stack[below + 1 + i].label;
+                    label = symbolNode(left, targetLevel);
+                    addPacked(label, prodIndex, kids);
+                }
+                stack.resize(stack.size() - length);
+                stack.push_back({ nextState, level, label });
+            }
+
+            // 1. 做完当前层的全部规约
+            while (!pending.empty()) {
+                Reduction r = pending.back();
+                pending.pop_back();
+                int length = static_cast<int>(grammar->productions[r.production].right.size());
+                kids.assign(length, -1);
+                forEachPath(nodes, edges, r, length, kids, [&](int target) {
+                    reduceTo(target, r.production, kids);
+                });
+            }
+
+            // 2. 输入结束：有栈顶可以接受则分析成功
+            if (token == grammar->endMarker) {
+                for (int x : frontier) {
+                    forEachAction(nodes[x].state, [&](uint32_t act) {
+                        if (actionKind(act) != ACTION_ACCEPT || result.accepted) return;
+                        for (int e = nodes[x].firstEdge; e >= 0; e = edges[e].next) {
+                            if (edges[e].target == root) forest.root = edges[e].label;
+                        }
+                        result.accepted = true;
+                    });
+                }
+                if (!result.accepted) result.errorPosition = level;
+                break;
+            }
+
+            // 3. 移进到下一层
+            shifts.clear();
+            for (int x : frontier) {
+                forEachAction(nodes[x].state, [&](uint32_t act) {
+                    if (actionKind(act) == ACTION_SHIFT) shifts.push_back({ x, actionTarget(act) });
+                });
+            }
+            if (shifts.empty()) {
+                result.errorPosition = level;
+                break;
+            }
+
+            int leaf = advance();
+            frontier.clear();
+            for (const auto& [from, state] : shifts) {
+                int node = findNode(state);
+                if (node < 0) node = addNode(state);
+                queueReductions(node, addEdge(node, from, leaf));
+            }
+        }
+        result.gssNodes = static_cast<int>(nodes.size());
+        return result;
+    }
+
+    // GLR分析结果的JSON：只输出从根可达的森林结点
+    crow::json::wvalue forestToJson(const GLRResult& result) const {
+        crow::json::wvalue json;
+        json["parse_result"] = result.accepted;
+        json["error_position"] = result.errorPosition;
+        json["gss_nodes"] = result.gssNodes;
+        json["max_frontier"] = result.maxFrontier;
+        json["tokens"] = result.tokens;
+
+        const Forest& forest = result.forest;
+        json["root"] = forest.root;
+        if (forest.root < 0) return json;
+
+        vector<char> reachable(forest.nodes.size(), 0);
+        vector<int> stack = { forest.root };
+        reachable[forest.root] = 1;
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            for (int p = forest.nodes[node].firstPacked; p >= 0; p = forest.packed[p].next) {
+                for (int c = 0; c < forest.packed[p].numChildren; c++) {
+                    int child = forest.children[forest.packed[p].firstChild + c];
+                    if (!reachable[child]) {
+                        reachable[child] = 1;
+                        stack.push_back(child);
+                    }
+                }
+            }
+        }
+
+        vector<crow::json::wvalue> nodesJson;
+        int ambiguous = 0;
+        for (size_t id = 0; id < forest.nodes.size(); id++) {
+            if (!reachable[id]) continue;
+            const Forest::Node& node = forest.nodes[id];
+            crow::json::wvalue nodeJson;
+            nodeJson["id"] = static_cast<int>(id);
+            nodeJson["symbol"] = grammar->symbols.name(node.symbol);
+            nodeJson["start"] = node.start;
+            nodeJson["end"] = node.end;
+
+            vector<crow::json::wvalue> alternatives;
+            for (int p = node.firstPacked; p >= 0; p = forest.packed[p].next) {
+                const Forest::Packed& packed = forest.packed[p];
+                const Production& prod = grammar->productions[packed.production];
+                string rule = grammar->symbols.name(prod.left) + " ->";
+                if (prod.isEpsilon()) rule += " ε";
+                for (int sym : prod.right) rule += " " + grammar->symbols.name(sym);
+
+                crow::json::wvalue alternative;
+                alternative["production"] = rule;
+                alternative["children"] = vector<int>(forest.children.begin() + packed.firstChild,
+                                                      forest.children.begin() + packed.firstChild + packed.numChildren);
+                alternatives.push_back(move(alternative));
+            }
+            if (alternatives.size() > 1) ambiguous++;
+            if (!alternatives.empty()) nodeJson["alternatives"] = move(alternatives);
+            nodesJson.push_back(move(nodeJson));
+        }
+        json["ambiguous_nodes"] = ambiguous;
+        json["forest"] = move(nodesJson);
+        return json;
+    }
+
+private:
+    struct GssNode {
+        int state;
+        int level;
+        int firstEdge;   // 指向更早结点的边的链表
+    };
+    struct GssEdge {
+        int target;
+        int label;       // SPPF中该边所跨符号的结点
+        int next;
+    };
+    // 规约：从node出发、长度为产生式右部长度的路径；edge为路径的第一条边（-1为不限），
+    // requiredEdge不为-1时只取经过该边、且第一条边不是它的路径（已有结点加边后补做的规约）
+    struct Reduction {
+        int node;
+        int edge;
+        int production;
+        int requiredEdge;
+    };
+
+    // 枚举规约路径，kids按从左到右的顺序填入路径上各边的标记，到达路径终点时调用f(终点)
+    template <typename F>
+    static void forEachPath(const vector<GssNode>& nodes, const vector<GssEdge>& edges, const Reduction& r,
+                            int length, vector<int>& kids, F&& f) {
+        walkPath(nodes, edges, r, r.node, 0, length, r.requiredEdge < 0, kids, f);
+    }
+
+    template <typename F>
+    static void walkPath(const vector<GssNode>& nodes, const vector<GssEdge>& edges, const Reduction& r,
+                         int node, int depth, int length, bool seenRequired, vector<int>& kids, F& f) {
+        if (depth == length) {
+            if (seenRequired) f(node);
+            return;
+        }
+        for (int e = nodes[node].firstEdge; e >= 0; e = edges[e].next) {
+            if (depth == 0 && r.edge >= 0 && e != r.edge) continue;
+            if (depth == 0 && e == r.requiredEdge) continue;
+            kids[length - 1 - depth] = edges[e].label;
+            walkPath(nodes, edges, r, edges[e].target, depth + 1, length, seenRequired || e == r.requiredEdge, kids, f);
+        }
+    }
+};
+
+// 只读映射的文件：POSIX上用mmap，其他平台整体读入内存
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+#ifdef _WIN32
+        ifstream in(path, ios::binary);
+        if (!in) throw runtime_error("Cannot open '" + path + "'");
+        buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("Cannot open '" + path + "'");
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw runtime_error("Cannot map empty file '" + path + "'");
+        }
+        size = static_cast<size_t>(st.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) throw runtime_error("Cannot mmap '" + path + "'");
+        data = static_cast<const char*>(mapped);
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data = nullptr;
+    size_t size = 0;
+
+private:
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+};
+
+// 映射文件上的分析表视图：直接读取映射的内存，打开时校验文件头、各段边界以及表中的每个状态号、产生式号和符号ID，
+// 损坏或截断的文件在打开时即被拒绝，分析过程中的查表不会越界
+// 提供与ParserBase相同的查询接口，可直接交给 ParserBase::recognizeWith 使用
+class TableView {
+public:
+    static shared_ptr<const TableView> open(const string& path) {
+        auto view = make_shared<TableView>();
+        view->file = make_shared<MappedFile>(path);
+        const char* base = view->file->data;
+        size_t size = view->file->size;
+
+        auto fail = [&path](const string& why) {
+            return runtime_error("Invalid compiled grammar '" + path + "': " + why);
+        };
+        if (size < sizeof(CompiledHeader)) throw fail("file too small");
+        const CompiledHeader& h = *reinterpret_cast<const CompiledHeader*>(base);
+        if (memcmp(h.magic, COMPILED_MAGIC, sizeof(h.magic)) != 0) throw fail("bad magic");
+        if (h.byteOrder != COMPILED_BYTE_ORDER) throw fail("byte order mismatch");
+        if (h.version != COMPILED_VERSION) throw fail("unsupported version " + to_string(h.version));
+        if (h.fileSize != size) throw fail("truncated file");
+        if (h.kind >= std::size(PARSER_KINDS)) throw fail("unknown parser kind");
+        if (h.numSymbols <= 0 || h.numTerminals <= 0 || h.numTerminals > h.numSymbols ||
+            h.numProductions <= 0 || h.numStates <= 0 ||
+            h.endMarker < 0 || h.endMarker >= h.numTerminals ||
+            h.startSymbol < h.numTerminals || h.startSymbol >= h.numSymbols ||
+            h.augmentedStartSymbol < h.numTerminals || h.augmentedStartSymbol >= h.numSymbols ||
+            h.augmentedProductionIndex < 0 || h.augmentedProductionIndex >= h.numProductions) throw fail("bad counts");
+
+        // 检查一个段 [at, at + bytes) 在文件内且按元素大小对齐
+        auto section = [&](uint64_t at, uint64_t count, size_t elemSize) {
+            if (at % elemSize != 0 || at > size || count > (size - at) / elemSize) throw fail("section out of bounds");
+            return base + at;
+        };
+        size_t numNonTerminals = static_cast<size_t>(h.numSymbols - h.numTerminals);
+        view->header = &h;
+        view->symbolOffsets = reinterpret_cast<const uint32_t*>(section(h.symbolOffsetsAt, h.numSymbols + uint64_t(1), sizeof(uint32_t)));
+        view->symbolNames = section(h.symbolNamesAt, view->symbolOffsets[h.numSymbols], 1);
+        view->prodLeft = reinterpret_cast<const int32_t*>(section(h.prodLeftAt, h.numProductions, sizeof(int32_t)));
+        view->prodRightOffsets = reinterpret_cast<const uint32_t*>(section(h.prodRightOffsetsAt, h.numProductions + uint64_t(1), sizeof(uint32_t)));
+        view->prodRight = reinterpret_cast<const int32_t*>(section(h.prodRightAt, view->prodRightOffsets[h.numProductions], sizeof(int32_t)));
+        view->actionTable = reinterpret_cast<const uint32_t*>(section(h.actionAt, static_cast<uint64_t>(h.numStates) * h.numTerminals, sizeof(uint32_t)));
+        view->gotoTable = reinterpret_cast<const int32_t*>(section(h.gotoAt, h.numStates * numNonTerminals, sizeof(int32_t)));
+        if (h.flags & COMPILED_HAS_ITEM_SETS) {
+            view->kernelOffsets = reinterpret_cast<const uint64_t*>(section(h.kernelOffsetsAt, h.numStates + uint64_t(1), sizeof(uint64_t)));
+            view->kernelItems = reinterpret_cast<const uint64_t*>(section(h.kernelItemsAt, view->kernelOffsets[h.numStates], sizeof(uint64_t)));
+        }
+
+        // 符号名：偏移单调；终结符名严格递增（terminalId在其上二分）
+        for (int i = 0; i < h.numSymbols; i++) {
+            if (view->symbolOffsets[i] > view->symbolOffsets[i + 1]) throw fail("bad symbol table");
+        }
+        for (int t = 1; t < h.numTerminals; t++) {
+            if (!(view->symbolName(t - 1) < view->symbolName(t))) throw fail("terminals not sorted");
+        }
+
+        // 产生式：偏移单调，左部为非终结符，右部符号ID有效；长度不超过状态数（规约时弹出的状态数）
+        for (int p = 0; p < h.numProductions; p++) {
+            if (view->prodRightOffsets[p] > view->prodRightOffsets[p + 1]) throw fail("bad productions");
+            if (view->prodLeft[p] < h.numTerminals || view->prodLeft[p] >= h.numSymbols) throw fail("bad productions");
+            if (view->prodRightOffsets[p + 1] - view->prodRightOffsets[p] > static_cast<uint32_t>(h.numStates)) throw fail("bad productions");
+        }
+        if (view->prodRightOffsets[0] != 0) throw fail("bad productions");
+        for (uint32_t i = 0; i < view->prodRightOffsets[h.numProductions]; i++) {
+            if (view->prodRight[i] < 0 || view->prodRight[i] >= h.numSymbols) throw fail("bad productions");
+        }
+
+        // ACTION表：移进目标为有效状态，规约目标为有效产生式；GOTO表：-1（无转移）或有效状态
+        size_t numActions = static_cast<size_t>(h.numStates) * h.numTerminals;
+        for (size_t i = 0; i < numActions; i++) {
+            uint32_t act = view->actionTable[i];
+            int target = actionTarget(act);
+            switch (actionKind(act)) {
+                case ACTION_SHIFT:
+                    if (target >= h.numStates) throw fail("shift target out of range");
+                    break;
+                case ACTION_REDUCE:
+                    if (target >= h.numProductions) throw fail("reduce target out of range");
+                    break;
+                default:
+                    if (target != 0) throw fail("bad action entry");
+                    break;
+            }
+        }
+        size_t numGotos = static_cast<size_t>(h.numStates) * numNonTerminals;
+        for (size_t i = 0; i < numGotos; i++) {
+            if (view->gotoTable[i] < -1 || view->gotoTable[i] >= h.numStates) throw fail("goto target out of range");
+        }
+
+        // 核心项目：偏移单调，产生式号有效，点的位置不超过右部长度
+        if (view->kernelOffsets) {
+            if (view->kernelOffsets[0] != 0) throw fail("bad item sets");
+            for (int st = 0; st < h.numStates; st++) {
+                if (view->kernelOffsets[st] > view->kernelOffsets[st + 1]) throw fail("bad item sets");
+            }
+            for (uint64_t i = 0; i < view->kernelOffsets[h.numStates]; i++) {
+                Item item;
+                item.key = view->kernelItems[i];
+                if (item.prodIndex() < 0 || item.prodIndex() >= h.numProductions || item.dotPos() < 0 ||
+                    item.dotPos() > view->productionLength(item.prodIndex())) throw fail("bad item sets");
+            }
+        }
+        return view;
+    }
+
+    string id() const {
+        ostringstream idStream;
+        idStream << hex << setw(16) << setfill('0') << header->grammarHash;
+        return idStream.str();
+    }
+    string kindName() const { return PARSER_KINDS[header->kind]; }
+    int numStates() const { return header->numStates; }
+    bool hasItemSets() const { return kernelOffsets != nullptr; }
+
+    string_view symbolName(int id) const {
+        return string_view(symbolNames + symbolOffsets[id], symbolOffsets[id + 1] - symbolOffsets[id]);
+    }
+
+    // 分析表查询接口（与ParserBase相同）
+    int terminalId(const string& name) const {
+        // 终结符ID按名字有序，直接二分
+        int lo = 0, hi = header->numTerminals;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (symbolName(mid) < name) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < header->numTerminals && symbolName(lo) == name ? lo : -1;
+    }
+    int endMarkerId() const { return header->endMarker; }
+    uint32_t action(int state, int terminal) const {
+        return actionTable[static_cast<size_t>(state) * header->numTerminals + terminal];
+    }
+    int gotoState(int state, int nonTerminal) const {
+        size_t numNonTerminals = static_cast<size_t>(header->numSymbols - header->numTerminals);
+        return gotoTable[static_cast<size_t>(state) * numNonTerminals + (nonTerminal - header->numTerminals)];
+    }
+    int productionLength(int prodIndex) const { return static_cast<int>(prodRightOffsets[prodIndex + 1] - prodRightOffsets[prodIndex]); }
+    int productionLeft(int prodIndex) const { return prodLeft[prodIndex]; }
+
+private:
+    shared_ptr<MappedFile> file;
+    const CompiledHeader* header = nullptr;
+    const uint32_t* symbolOffsets = nullptr;
+    const char* symbolNames = nullptr;
+    const int32_t* prodLeft = nullptr;
+    const uint32_t* prodRightOffsets = nullptr;
+    const int32_t* prodRight = nullptr;
+    const uint32_t* actionTable = nullptr;
+    const int32_t* gotoTable = nullptr;
+    const uint64_t* kernelOffsets = nullptr;
+    const uint64_t* kernelItems = nullptr;
+};
+
+// 推送式语法分析器：输入符号由调用者逐个或分块送入，分析状态（状态栈、已读符号数、未切分完的符号）
+// 全部保存在对象中，两次送入之间可以任意暂停，适合从网络流或词法分析器边读边分析；对象可以复制，用作检查点
+// Tables同recognizeWith；以shared_ptr构造时分析器持有分析表，以引用构造时由调用者保证分析表存活
+template <typename Tables>
+class PushParser {
+public:
+    explicit PushParser(shared_ptr<const Tables> owned) : tables(owned.get()), owner(move(owned)) {}
+    explicit PushParser(const Tables& borrowed) : tables(&borrowed) {}
+
+    // 送入一个终结符ID（未知符号为-1），返回是否还能继续送入（出错或接受后为false）
+    bool feedToken(int terminal) {
+        if (done) return false;
+        while (true) {
+            result.steps++;
+            uint32_t act = terminal >= 0 ? tables->action(stateStack.back(), terminal) : makeAction(ACTION_ERROR);
+
+            if (actionKind(act) == ACTION_SHIFT) {
+                stateStack.push_back(actionTarget(act));
+                tokenIndex++;
+                return true;
+            }
+            else if (actionKind(act) == ACTION_REDUCE) {
+                int prodIndex = static_cast<int>(actionTarget(act));
+                if (reductionLog) reductionLog->push_back(prodIndex);
+                size_t length = static_cast<size_t>(tables->productionLength(prodIndex));
+                if (length >= stateStack.size()) break;  // 与栈不符的规约（仅可能来自损坏的分析表）
+                stateStack.resize(stateStack.size() - length);
+                int nextState = tables->gotoState(stateStack.back(), tables->productionLeft(prodIndex));
+                if (nextState < 0) break;
+                stateStack.push_back(nextState);
+            }
+            else if (actionKind(act) == ACTION_ACCEPT) {
+                result.accepted = true;
+                done = true;
+                return false;
+            }
+            else {
+                break;
+            }
+        }
+
+        result.errorPosition = tokenIndex;
+        done = true;
+        return false;
+    }
+
+    // 送入一个完整的符号；feedText留下的未完结符号先作为一个符号送入
+    bool feed(const string& token) {
+        flushPartial();
+        return feedToken(tables->terminalId(token));
+    }
+
+    bool feed(const vector<string>& tokens) {
+        for (const auto& token : tokens) {
+            if (!feed(token)) break;
+        }
+        return !done;
+    }
+
+    // 送入一段原始文本，切分规则与parse()中的 Grammar::split(input, ' ') 一致：按空格切分，
+    // 去掉两端的制表符，跳过空符号；末尾未以空格结束的部分暂存，与下一段拼接，因此符号可以跨块
+    bool feedText(string_view chunk) {
+        size_t pos = 0;
+        while (!done) {
+            size_t space = chunk.find(' ', pos);
+            if (space == string_view::npos) {
+                partial.append(chunk.substr(pos));
+                break;
+            }
+            partial.append(chunk.substr(pos, space - pos));
+            flushPartial();
+            pos = space + 1;
+        }
+        return !done;
+    }
+
+    // 输入结束：送入结束符#，返回识别结果（可重复调用）
+    ParserBase::RecognizeResult finish() {
+        flushPartial();
+        feedToken(tables->endMarkerId());
+        return result;
+    }
+
+    // 把每次规约的产生式ID追加到log（为空时不记录）
+    void logReductions(vector<int>* log) { reductionLog = log; }
+
+    bool finished() const { return done; }
+    const ParserBase::RecognizeResult& status() const { return result; }
+    int tokensConsumed() const { return tokenIndex; }
+    int stackDepth() const { return static_cast<int>(stateStack.size()); }
+
+private:
+    void flushPartial() {
+        size_t start = partial.find_first_not_of('\t');
+        if (start != string::npos) {
+            partial.erase(partial.find_last_not_of('\t') + 1);
+            partial.erase(0, start);
+            feedToken(tables->terminalId(partial));
+        }
+        partial.clear();
+    }
+
+    const Tables* tables;
+    shared_ptr<const Tables> owner;
+    vector<int> stateStack = { 0 };
+    ParserBase::RecognizeResult result;
+    int tokenIndex = 0;       // 已移进的输入符号数，即下一个输入符号的下标
+    string partial;           // feedText中尚未切分完的符号
+    vector<int>* reductionLog = nullptr;
+    bool done = false;
+};
+
+// 增量分析器：保存最近一次成功分析的语法树，编辑后只重新分析编辑附近的部分（Wagner–Graham的状态匹配）
+// 左侧上下文：移进编辑点前一个符号后的LR栈，恰好是语法树中通向该符号的路径左侧的各子树，直接从树上恢复；
+// 右侧上下文：编辑范围之后的各极大子树，栈顶状态与子树当初压栈时的状态相同时整棵移进，否则拆开再试
+// 每次重新分析的代价与编辑大小加上编辑处语法树的深度成正比
+class IncrementalParser {
+public:
+    struct Node {
+        int symbol;
+        int production;    // 规约所用的产生式，终结符为-1
+        int leftState;     // 压入该结点时的栈顶状态
+        int size;          // 覆盖的输入符号数
+        int firstChild;    // 子结点在children中的起始下标
+        int numChildren;
+    };
+
+    struct Stats {
+        bool accepted = false;
+        int errorPosition = -1;   // 出错时所在输入符号的下标，接受时为-1
+        int reusedNodes = 0;      // 整棵移进的旧子树数
+        int newNodes = 0;         // 新建的结点数
+        int shiftedTokens = 0;    // 逐个移进的输入符号数
+        int brokenDown = 0;       // 因状态不匹配而拆开的旧子树数
+    };
+
+    explicit IncrementalParser(shared_ptr<const ParserBase> tables) : parser(move(tables)) {
+        if (parser->actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+    }
+
+    // 把输入符号 [start, end) 替换为replacement，然后增量地重新分析
+    // 分析出错时保留原来的语法树，编辑范围累积到下次编辑一起重新分析
+    Stats edit(int start, int end, const vector<string>& replacement) {
+        if (start < 0 || end < start || end > static_cast<int>(tokens.size())) {
+            throw runtime_error("Edit range out of bounds");
+        }
+
+        // 合并到累积的编辑范围：当前输入的 [dirtyStart, dirtyEnd) 替换了语法树输入的 [dirtyStart, treeDirtyEnd)
+        if (dirtyStart < 0) {
+            dirtyStart = start;
+            dirtyEnd = end;
+            treeDirtyEnd = end;
+        }
+        if (end > dirtyEnd) {
+            treeDirtyEnd += end - dirtyEnd;
+            dirtyEnd = end;
+        }
+        dirtyStart = min(dirtyStart, start);
+        dirtyEnd += static_cast<int>(replacement.size()) - (end - start);
+
+        vector<int> ids;
+        for (const auto& token : replacement) ids.push_back(parser->terminalId(token));
+        tokens.erase(tokens.begin() + start, tokens.begin() + end);
+        tokens.insert(tokens.begin() + start, ids.begin(), ids.end());
+        return reparse();
+    }
+
+    int numTokens() const { return static_cast<int>(tokens.size()); }
+
+    // 语法树是否与当前输入一致（最近一次分析成功）
+    bool upToDate() const { return dirtyStart < 0; }
+
+    // 语法树的扁平后序表示，与parse()的语法树相同（见ParserBase::TREE_NODE_FIELDS）
+    vector<int> flatTree() const {
+        vector<int> flat;
+        struct Frame {
+            int node;
+            int start;
+            int nextChild;
+            int childStart;
+        };
+        vector<Frame> stack;
+        if (root >= 0) stack.push_back({ root, 0, 0, 0 });
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            const Node& node = nodes[frame.node];
+            if (frame.nextChild < node.numChildren) {
+                int child = children[node.firstChild + frame.nextChild++];
+                int childStart = frame.childStart;
+                frame.childStart += nodes[child].size;
+                stack.push_back({ child, childStart, 0, childStart });
+                continue;
+            }
+            flat.insert(flat.end(), { node.production, node.numChildren, frame.start, frame.start + node.size });
+            stack.pop_back();
+        }
+        return flat;
+    }
+
+    crow::json::wvalue treeToJson() const {
+        crow::json::wvalue json;
+        json = flatTree();
+        return json;
+    }
+
+    static crow::json::wvalue toJson(const Stats& stats) {
+        crow::json::wvalue json;
+        json["parse_result"] = stats.accepted;
+        json["error_position"] = stats.errorPosition;
+        json["reused_nodes"] = stats.reusedNodes;
+        json["new_nodes"] = stats.newNodes;
+        json["shifted_tokens"] = stats.shiftedTokens;
+        json["broken_down"] = stats.brokenDown;
+        return json;
+    }
+
+private:
+    // 在状态state上压入符号symbol后的状态
+    int transition(int state, int symbol) const {
+        if (parser->grammar->symbols.isTerminal(symbol)) return actionTarget(parser->action(state, symbol));
+        return parser->gotoState(state, symbol);
+    }
+
+    Stats reparse() {
+        Stats stats;
+        const int numInput = static_cast<int>(tokens.size());
+        vector<int> stateStack = { 0 };
+        vector<int> nodeStack = { -1 };
+
+        // 1. 左侧上下文：沿通向第dirtyStart-1个符号的路径，取路径左侧的子树和该符号本身
+        if (root >= 0 && dirtyStart > 0) {
+            int target = dirtyStart - 1;
+            int node = root, start = 0;
+            while (node >= 0) {
+                if (nodes[node].numChildren == 0) {
+                    stateStack.push_back(transition(stateStack.back(), nodes[node].symbol));
+                    nodeStack.push_back(node);
+                    break;
+                }
+                int next = -1;
+                for (int i = 0; i < nodes[node].numChildren && next < 0; i++) {
+                    int child = children[nodes[node].firstChild + i];
+                    if (start + nodes[child].size <= target) {
+                        stateStack.push_back(transition(stateStack.back(), nodes[child].symbol));
+                        nodeStack.push_back(child);
+                        start += nodes[child].size;
+                    } else {
+                        next = child;
+                    }
+                }
+                node = next;
+            }
+        }
+
+        // 2. 右侧上下文：语法树输入中treeDirtyEnd之后的各极大子树（跳过空子树），倒序存放，back为下一个
+        vector<int> pending;
+        if (root >= 0 && treeDirtyEnd == 0) {
+            if (nodes[root].size > 0) pending.push_back(root);
+        } else if (root >= 0 && treeDirtyEnd < nodes[root].size) {
+            int node = root, start = 0;
+            while (node >= 0) {
+                int next = -1, nextStart = 0, childStart = start;
+                size_t later = pending.size();
+                for (int i = 0; i < nodes[node].numChildren; i++) {
+                    int child = children[nodes[node].firstChild + i];
+                    int childEnd = childStart + nodes[child].size;
+                    if (childStart >= treeDirtyEnd) {
+                        if (nodes[child].size > 0) pending.push_back(child);
+                    } else if (childEnd > treeDirtyEnd) {
+                        next = child;
+                        nextStart = childStart;
+                    }
+                    childStart = childEnd;
+                }
+                reverse(pending.begin() + later, pending.end());
+                node = next;
+                start = nextStart;
+            }
+        }
+
+        // 3. 从编辑点继续分析：编辑范围内的符号逐个移进，之后优先整棵移进旧子树
+        int pos = dirtyStart;
+        int newRoot = -1;
+        while (true) {
+            int state = stateStack.back();
+            if (pos >= dirtyEnd && !pending.empty() && nodes[pending.back()].leftState == state) {
+                int reused = pending.back();
+                pending.pop_back();
+                stateStack.push_back(transition(state, nodes[reused].symbol));
+                nodeStack.push_back(reused);
+                pos += nodes[reused].size;
+                stats.reusedNodes++;
+                continue;
+            }
+
+            int lookahead = pos < numInput ? tokens[pos] : parser->endMarkerId();
+            uint32_t act = lookahead >= 0 ? parser->action(state, lookahead) : makeAction(ACTION_ERROR);
+
+            if (actionKind(act) == ACTION_REDUCE) {
+                int prodIndex = static_cast<int>(actionTarget(act));
+                int length = parser->productionLength(prodIndex);
+                int base = static_cast<int>(stateStack.size()) - length;
+                int nextState = parser->gotoState(stateStack[base - 1], parser->productionLeft(prodIndex));
+                if (nextState < 0) break;
+
+                Node node = { parser->productionLeft(prodIndex), prodIndex, stateStack[base - 1], 0,
+                              static_cast<int>(children.size()), length };
+                for (int i = base; i < base + length; i++) {
+                    node.size += nodes[nodeStack[i]].size;
+                    children.push_back(nodeStack[i]);
+                }
+                nodes.push_back(node);
+                stats.newNodes++;
+                stateStack.resize(base);
+                nodeStack.resize(base);
+                stateStack.push_back(nextState);
+                nodeStack.push_back(static_cast<int>(nodes.size()) - 1);
+            }
+            else if (actionKind(act) == ACTION_SHIFT) {
+                if (pos >= dirtyEnd) {
+                    // 状态不匹配的旧子树：非终结符拆成子结点，终结符换成新结点
+                    int old = pending.back();
+                    pending.pop_back();
+                    if (nodes[old].numChildren > 0) {
+                        for (int i = nodes[old].numChildren - 1; i >= 0; i--) {
+                            int child = children[nodes[old].firstChild + i];
+                            if (nodes[child].size > 0) pending.push_back(child);
+                        }
+                        stats.brokenDown++;
+                        continue;
+                    }
+                }
+                nodes.push_back({ lookahead, -1, state, 1, 0, 0 });
+                stats.newNodes++;
+                stats.shiftedTokens++;
+                stateStack.push_back(actionTarget(act));
+                nodeStack.push_back(static_cast<int>(nodes.size()) - 1);
+                pos++;
+            }
+            else if (actionKind(act) == ACTION_ACCEPT) {
+                newRoot = nodeStack.back();
+                break;
+            }
+            else {
+                break;
+            }
+        }
+
+        if (newRoot < 0) {
+            stats.errorPosition = pos;
+            return stats;
+        }
+
+        stats.accepted = true;
+        root = newRoot;
+        dirtyStart = dirtyEnd = treeDirtyEnd = -1;
+        if (nodes.size() > 2 * compactedSize + 1024) compact();
+        return stats;
+    }
+
+    // 丢弃不再属于语法树的结点；子结点总是先于父结点建立，按下标顺序复制即可保持这一性质
+    void compact() {
+        vector<int> remap(nodes.size(), -1);
+        remap[root] = 0;
+        for (int i = root; i >= 0; i--) {
+            if (remap[i] < 0) continue;
+            for (int c = 0; c < nodes[i].numChildren; c++) remap[children[nodes[i].firstChild + c]] = 0;
+        }
+
+        vector<Node> liveNodes;
+        vector<int> liveChildren;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (remap[i] < 0) continue;
+            Node node = nodes[i];
+            node.firstChild = static_cast<int>(liveChildren.size());
+            for (int c = 0; c < node.numChildren; c++) liveChildren.push_back(remap[children[nodes[i].firstChild + c]]);
+            remap[i] = static_cast<int>(liveNodes.size());
+            liveNodes.push_back(node);
+        }
+        root = remap[root];
+        nodes = move(liveNodes);
+        children = move(liveChildren);
+        compactedSize = nodes.size();
+    }
+
+    shared_ptr<const ParserBase> parser;
+    vector<int> tokens;          // 当前输入符号的ID，未知符号为-1
+    vector<Node> nodes;          // 结点池，只追加，由compact()回收
+    vector<int> children;
+    int root = -1;               // 最近一次成功分析的语法树（开始符号的结点）
+    // 自那次分析以来累积的编辑；全部输入都未分析时为 [0, 0) 替换语法树的 [0, 0)
+    int dirtyStart = 0;
+    int dirtyEnd = 0;
+    int treeDirtyEnd = 0;
+    size_t compactedSize = 0;
+};
+
+// 由分析表生成独立的C++头文件：constexpr的ACTION/GOTO表、产生式长度和左部，以及模板化的分析循环
+// 生成的分析器与 ParserBase::parse 接受相同的语言（输入符号的切分方式也相同）
+class CppGenerator {
+public:
+    static string tableDriven(const ParserBase& parser, const string& nameSpace) {
+        if (parser.actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+
+        const Grammar& grammar = *parser.grammar;
+        const SymbolTable& symbols = grammar.symbols;
+        int numStates = static_cast<int>(parser.automaton->itemSets.size());
+        int numNonTerminals = symbols.size() - symbols.numTerminals;
+
+        ostringstream out;
+        writePreamble(out, parser);
+        out << "namespace " << identifier(nameSpace) << " {\n\n";
+        out << "constexpr int NUM_TERMINALS = " << symbols.numTerminals << ";\n";
+        out << "constexpr int NUM_NON_TERMINALS = " << numNonTerminals << ";\n";
+        out << "constexpr int NUM_STATES = " << numStates << ";\n";
+        out << "constexpr int END_MARKER = " << grammar.endMarker << ";\n\n";
+        writeTerminalNames(out, symbols);
+
+        out << "// ACTION表：高2位为动作类型（0出错 1移进 2规约 3接受），低30位为状态号或产生式号\n";
+        writeArray(out, "std::uint32_t", "ACTION", parser.actionTable);
+        out << "// GOTO表：列为非终结符ID减去NUM_TERMINALS，-1表示没有转移\n";
+        writeArray(out, "std::int32_t", "GOTO", parser.gotoTable);
+        writeProductions(out, grammar);
+        writeResult(out);
+
+        out << R"(// 分析循环：nextToken() 返回下一个终结符ID，输入结束时返回END_MARKER，未知符号返回-1
+template <typename NextToken>
+Result parseTokens(NextToken&& nextToken) {
+    Result result;
+    std::vector<int> stateStack;
+    stateStack.reserve(64);
+    stateStack.push_back(0);
+    int tokenIndex = 0;
+    int currentToken = nextToken();
+    while (true) {
+        result.steps++;
+        std::uint32_t act = currentToken >= 0
+            ? ACTION[static_cast<std::size_t>(stateStack.back()) * NUM_TERMINALS + currentToken] : 0u;
+        std::uint32_t target = act & 0x3FFFFFFFu;
+        switch (act >> 30) {
+            case 1:
+                stateStack.push_back(static_cast<int>(target));
+                currentToken = nextToken();
+                tokenIndex++;
+                continue;
+            case 2: {
+                stateStack.resize(stateStack.size() - PRODUCTION_LENGTH[target]);
+                int next = GOTO[static_cast<std::size_t>(stateStack.back()) * NUM_NON_TERMINALS
+                                + (PRODUCTION_LEFT[target] - NUM_TERMINALS)];
+                if (next < 0) break;
+                stateStack.push_back(next);
+                continue;
+            }
+            case 3:
+                result.accepted = true;
+                return result;
+            default:
+                break;
+        }
+        break;
+    }
+    result.errorPosition = tokenIndex;
+    return result;
+}
+
+)";
+        writeStringParse(out);
+        out << "}  // namespace " << identifier(nameSpace) << "\n";
+        return out.str();
+    }
+
+    // 直接编码（递归上升式）的分析器：每个状态一个标号，按当前符号switch分派，不查表
+    // 规约后跳到左部非终结符的标号，再按栈顶状态switch跳到GOTO目标；接口与tableDriven相同
+    static string directCoded(const ParserBase& parser, const string& nameSpace) {
+        if (parser.actionTable.empty()) {
+            throw runtime_error("Parse table has not been built");
+        }
+
+        const Grammar& grammar = *parser.grammar;
+        const SymbolTable& symbols = grammar.symbols;
+        int numStates = static_cast<int>(parser.automaton->itemSets.size());
+        int numTerminals = symbols.numTerminals;
+
+        ostringstream out;
+        writePreamble(out, parser);
+        out << "namespace " << identifier(nameSpace) << " {\n\n";
+        out << "constexpr int NUM_TERMINALS = " << numTerminals << ";\n";
+        out << "constexpr int NUM_STATES = " << numStates << ";\n";
+        out << "constexpr int END_MARKER = " << grammar.endMarker << ";\n\n";
+        writeTerminalNames(out, symbols);
+        writeResult(out);
+
+        out << "// 分析循环：nextToken() 返回下一个终结符ID，输入结束时返回END_MARKER，未知符号返回-1\n"
+            << "template <typename NextToken>\n"
+            << "Result parseTokens(NextToken&& nextToken) {\n"
+            << "    Result result;\n"
+            << "    std::vector<int> stateStack;\n"
+            << "    stateStack.reserve(64);\n"
+            << "    stateStack.push_back(0);\n"
+            << "    int tokenIndex = 0;\n"
+            << "    int currentToken = nextToken();\n";
+
+        // 只为会跳转到的状态生成标号（初始状态通常没有入边）
+        vector<char> entered(numStates, 0);
+        for (const auto& edges : parser.automaton->transitions) {
+            for (const auto& edge : edges) entered[edge.target] = 1;
+        }
+
+        // 每个状态：动作相同的终结符合并为同一个case
+        vector<char> reducedTo(symbols.size(), 0);   // 作为规约左部出现过的非终结符
+        for (int state = 0; state < numStates; state++) {
+            map<uint32_t, vector<int>> terminalsByAction;
+            for (int term = 0; term < numTerminals; term++) {
+                uint32_t act = parser.action(state, term);
+                if (actionKind(act) != ACTION_ERROR) terminalsByAction[act].push_back(term);
+            }
+
+            if (entered[state]) out << "state_" << state << ":\n";
+            out << "    result.steps++;\n"
+                << "    switch (currentToken) {\n";
+            for (const auto& entry : terminalsByAction) {
+                out << "       ";
+                for (int term : entry.second) out << " case " << term << ":";
+                out << "  //";
+                for (int term : entry.second) out << " " << symbols.name(term);
+                out << "\n";
+
+                uint32_t act = entry.first;
+                int target = actionTarget(act);
+                if (actionKind(act) == ACTION_SHIFT) {
+                    out << "            stateStack.push_back(" << target << ");\n"
+                        << "            currentToken = nextToken();\n"
+                        << "            tokenIndex++;\n"
+                        << "            goto state_" << target << ";\n";
+                }
+                else if (actionKind(act) == ACTION_REDUCE) {
+                    const Production& prod = grammar.productions[target];
+                    reducedTo[prod.left] = 1;
+                    out << "            // " << productionText(grammar, prod) << "\n";
+                    if (!prod.right.empty()) {
+                        out << "            stateStack.resize(stateStack.size() - " << prod.right.size() << ");\n";
+                    }
+                    out << "            goto nonterminal_" << prod.left << ";\n";
+                }
+                else {
+                    out << "            result.accepted = true;\n"
+                        << "            return result;\n";
+                }
+            }
+            out << "        default:\n"
+                << "            goto error;\n"
+                << "    }\n";
+        }
+
+        // 每个非终结符：按规约后露出的栈顶状态跳到GOTO目标
+        for (int nonTerminal = numTerminals; nonTerminal < symbols.size(); nonTerminal++) {
+            if (!reducedTo[nonTerminal]) continue;
+            out << "nonterminal_" << nonTerminal << ":  // " << symbols.name(nonTerminal) << "\n"
+                << "    switch (stateStack.back()) {\n";
+            for (int state = 0; state < numStates; state++) {
+                int target = parser.gotoState(state, nonTerminal);
+                if (target < 0) continue;
+                out << "        case " << state << ":\n"
+                    << "            stateStack.push_back(" << target << ");\n"
+                    << "            goto state_" << target << ";\n";
+            }
+            out << "        default:\n"
+                << "            goto error;\n"
+                << "    }\n";
+        }
+
+        out << "error:\n"
+            << "    result.errorPosition = tokenIndex;\n"
+            << "    return result;\n"
+            << "}\n\n";
+        writeStringParse(out);
+        out << "}  // namespace " << identifier(nameSpace) << "\n";
+        return out.str();
+    }
+
+    // 按风格生成："table" 为表驱动，"direct" 为直接编码
+    static string generate(const ParserBase& parser, const string& nameSpace, const string& style) {
+        if (style == "table") return tableDriven(parser, nameSpace);
+        if (style == "direct") return directCoded(parser, nameSpace);
+        throw runtime_error("Unknown style '" + style + "'");
+    }
+
+    // 把任意字符串变成合法的C++标识符
+    static string identifier(const string& name) {
+        string id;
+        for (char c : name) {
+            id += isalnum(static_cast<unsigned char>(c)) || c == '_' ? c : '_';
+        }
+        if (id.empty() || isdigit(static_cast<unsigned char>(id[0]))) id = "_" + id;
+        return id;
+    }
+
+private:
+    static string quoted(const string& text) {
+        string result = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') result += '\\';
+            result += c;
+        }
+        return result + "\"";
+    }
+
+    static void writePreamble(ostringstream& out, const ParserBase& parser) {
+        out << "// 由FEISU根据以下文法生成的" << parser.kindName() << "分析器，请勿手工修改\n";
+        istringstream grammarText(parser.grammar->normalized());
+        string line;
+        while (getline(grammarText, line)) out << "//   " << line << "\n";
+        out << "#pragma once\n\n"
+            << "#include <cstddef>\n"
+            << "#include <cstdint>\n"
+            << "#include <string_view>\n"
+            << "#include <vector>\n\n";
+    }
+
+    static string productionText(const Grammar& grammar, const Production& prod) {
+        string text = grammar.symbols.name(prod.left) + " ->";
+        for (int sym : prod.right) text += " " + grammar.symbols.name(sym);
+        return text;
+    }
+
+    static void writeResult(ostringstream& out) {
+        out << R"(struct Result {
+    bool accepted = false;
+    int errorPosition = -1;   // 出错时所在输入符号的下标，接受时为-1
+    int steps = 0;
+};
+
+)";
+    }
+
+    static void writeTerminalNames(ostringstream& out, const SymbolTable& symbols) {
+        out << "// 终结符名字，下标即终结符ID（按名字有序）\n";
+        out << "constexpr std::string_view TERMINAL_NAMES[NUM_TERMINALS] = {";
+        for (int id = 0; id < symbols.numTerminals; id++) {
+            out << (id % 8 == 0 ? "\n    " : " ") << quoted(symbols.name(id)) << ",";
+        }
+        out << "\n};\n\n";
+    }
+
+    template <typename T>
+    static void writeArray(ostringstream& out, const char* type, const char* name, const vector<T>& values) {
+        out << "constexpr " << type << " " << name << "[] = {";
+        for (size_t i = 0; i < values.size(); i++) {
+            out << (i % 16 == 0 ? "\n    " : " ") << values[i] << (is_unsigned<T>::value ? "u," : ",");
+        }
+        out << "\n};\n\n";
+    }
+
+    static void writeProductions(ostringstream& out, const Grammar& grammar) {
+        vector<uint32_t> lengths;
+        vector<int> lefts;
+        for (const auto& prod : grammar.productions) {
+            lengths.push_back(static_cast<uint32_t>(prod.right.size()));
+            lefts.push_back(prod.left);
+        }
+        out << "// 产生式右部长度和左部符号ID，下标为产生式编号\n";
+        writeArray(out, "std::uint32_t", "PRODUCTION_LENGTH", lengths);
+        writeArray(out, "std::int32_t", "PRODUCTION_LEFT", lefts);
+    }
+
+    static void writeStringParse(ostringstream& out) {
+        out << R"(// 终结符名字到ID，未知符号返回-1
+inline int terminalId(std::string_view name) {
+    int lo = 0, hi = NUM_TERMINALS;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (TERMINAL_NAMES[mid] < name) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo < NUM_TERMINALS && TERMINAL_NAMES[lo] == name ? lo : -1;
+}
+
+// 分析输入串：按空格切分，去掉符号两端的制表符
+inline Result parse(std::string_view input) {
+    std::size_t pos = 0;
+    return parseTokens([&]() -> int {
+        while (true) {
+            while (pos < input.size() && (input[pos] == ' ' || input[pos] == '\t')) pos++;
+            if (pos == input.size()) return END_MARKER;
+            std::size_t start = pos;
+            while (pos < input.size() && input[pos] != ' ') pos++;
+            std::size_t end = pos;
+            while (end > start && input[end - 1] == '\t') end--;
+            if (end > start) return terminalId(input.substr(start, end - start));
+        }
+    });
+}
+
+)";
+    }
+};
+
+// 解决CORS问题的中间件
+struct CORSMiddleware {
+    struct context {};
+    
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        // 设置CORS头
+        res.add_header("Access-Control-Allow-Origin", "*");
+        res.add_header("Access-Control-Allow-Headers", "Content-Type");
+        
+        // 处理OPTIONS预检请求
+        if (req.method == crow::HTTPMethod::Options) {
+            res.code = crow::OK;
+            res.end();
+        }
+    }
+    
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {}
+};
+
+// 一次带轨迹的分析，连同产生它的快照一起保存，供 /api/parse_steps 按窗口读取
+struct TracedParse {
+    shared_ptr<const ParserBase> compiled;
+    ParserBase::ParseTrace trace;
+};
+
+// 分析轨迹缓存：按trace_id保存带轨迹的分析，多个客户端交替分析时各自的trace_id都仍然有效；
+// 与GrammarRegistry相同，按字节计量，超出预算时淘汰最久未读取的轨迹
+class TraceStore {
+public:
+    explicit TraceStore(size_t budgetBytes) : budget(budgetBytes) {}
+
+    // owner为产生轨迹的分析器槽位名，换文法时按它丢弃
+    void add(const string& owner, shared_ptr<const TracedParse> parse) {
+        lock_guard<mutex> lock(mtx);
+        int id = parse->trace.id;
+        lru.push_front(id);
+        Entry entry{ owner, parse->trace.memoryUsage(), move(parse), lru.begin() };
+        usedBytes += entry.bytes;
+        entries[id] = move(entry);
+
+        // 淘汰最久未读取的轨迹，刚加入的总是保留
+        while (usedBytes > budget && lru.size() > 1) {
+            auto victim = entries.find(lru.back());
+            usedBytes -= victim->second.bytes;
+            entries.erase(victim);
+            lru.pop_back();
+        }
+    }
+
+    // 按trace_id查找，找不到（已淘汰或已丢弃）时返回空指针
+    shared_ptr<const TracedParse> find(int id) {
+        lock_guard<mutex> lock(mtx);
+        auto it = entries.find(id);
+        if (it == entries.end()) return nullptr;
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+        return it->second.parse;
+    }
+
+    // 丢弃owner在grammar上产生的轨迹（该槽位换了文法）；同一文法上重新构造分析表不影响已有轨迹
+    void dropGrammar(const string& owner, const Grammar* grammar) {
+        lock_guard<mutex> lock(mtx);
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.owner == owner && it->second.parse->compiled->grammar.get() == grammar) {
+                usedBytes -= it->second.bytes;
+                lru.erase(it->second.lruPos);
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    size_t size() {
+        lock_guard<mutex> lock(mtx);
+        return entries.size();
+    }
+
+private:
+    struct Entry {
+        string owner;
+        size_t bytes = 0;
+        shared_ptr<const TracedParse> parse;
+        list<int>::iterator lruPos;
+    };
+
+    mutex mtx;
+    size_t budget;
+    size_t usedBytes = 0;
+    list<int> lru;                            // 最近读取的在前
+    unordered_map<int, Entry> entries;
+};
+
+// 分析器槽位：保存已发布的只读分析器快照（编译好的文法和分析表）
+// 读请求用atomic_load取得快照后无锁使用，每个请求有自己的栈和轨迹；
+// 加载文法和构造分析表在副本上完成，再用atomic_store整体替换（RCU），旧快照随最后一个引用释放
+struct ParserSlot {
+    string typeName;                             // 如 "SLR(1)"
+    function<shared_ptr<ParserBase>()> create;   // 创建空分析器
+    shared_ptr<const ParserBase> compiled;       // 只通过 snapshot()/publish() 原子访问
+    string kind;                                 // 分析器种类名，如 "slr1"（见PARSER_KINDS）
+    shared_ptr<const TracedParse> lastParse;     // 最近一次带轨迹的分析，只通过 latestParse()/parseTraced() 原子访问
+    TraceStore& traces;                          // 所有槽位共用的轨迹缓存
+    mutex writeMutex;                            // 串行化写者，读者不加锁
+
+    ParserSlot(const string& name, function<shared_ptr<ParserBase>()> factory, TraceStore& traceStore)
+        : typeName(name), create(factory), compiled(factory()), kind(compiled->kindName()), traces(traceStore) {}
+
+    shared_ptr<const ParserBase> snapshot() const {
+        return atomic_load(&compiled);
+    }
+
+    // 发布新快照（调用者须持有writeMutex）
+    // 换了文法时丢弃旧文法上的轨迹；只是重新构造分析表时，已有轨迹连同其快照仍可读取
+    void publish(shared_ptr<const ParserBase> parser) {
+        auto previous = snapshot();
+        bool grammarChanged = previous->grammar != parser->grammar;
+        atomic_store(&compiled, move(parser));
+        atomic_store(&lastParse, shared_ptr<const TracedParse>());
+        if (grammarChanged) traces.dropGrammar(typeName, previous->grammar.get());
+    }
+
+    shared_ptr<const TracedParse> latestParse() const {
+        return atomic_load(&lastParse);
+    }
+
+    // 在当前快照的副本上构造分析表并发布
+    shared_ptr<const ParserBase> rebuild() {
+        lock_guard<mutex> lock(writeMutex);
+        shared_ptr<ParserBase> parser = snapshot()->clone();
+        parser->buildParseTable();
+        publish(parser);
+        return parser;
+    }
+
+    // 当前快照的JSON，附带基于该快照的最近一次分析
+    crow::json::wvalue toJson() const {
+        auto parser = snapshot();
+        auto last = latestParse();
+        auto json = parser->toJson(last && last->compiled == parser ? &last->trace : nullptr);
+        json["parser_type"] = typeName;
+        return json;
+    }
+
+    // 分析输入串：trace为false时只做识别；inlineSteps为false时不内联分析步骤，前端凭trace_id按窗口读取；
+    // output为reductions或reductions_base64时只返回规约序列（见ParserBase::isOutputMode）
+    crow::json::wvalue parse(const string& input, bool trace, bool inlineSteps, const string& output = "steps") {
+        auto parser = snapshot();
+        crow::json::wvalue json;
+        if (output != "steps") {
+            vector<int> sequence;
+            auto result = parser->reductions(input, sequence);
+            json = ParserBase::toJson(result, sequence, output == "reductions_base64");
+        } else if (trace) {
+            auto last = parseTraced(input);
+            json = last->compiled->toJson(&last->trace, inlineSteps);
+            json["trace_id"] = last->trace.id;
+            json["step_count"] = static_cast<int>(last->trace.ops.size());
+        } else {
+            json = ParserBase::toJson(parser->recognize(input));
+        }
+        json["parser_type"] = typeName;
+        return json;
+    }
+
+    // 在当前快照上带轨迹地分析，轨迹存入轨迹缓存并成为本槽位的最近一次分析
+    shared_ptr<const TracedParse> parseTraced(const string& input) {
+        auto last = make_shared<TracedParse>();
+        last->compiled = snapshot();
+        last->compiled->parse(input, last->trace);
+        shared_ptr<const TracedParse> stored = move(last);
+        traces.add(typeName, stored);
+        atomic_store(&lastParse, stored);
+        return stored;
+    }
+};
+
+// 按名字创建空分析器：lr0 / slr1 / lalr1 / lr1，未知名字返回空指针
+shared_ptr<ParserBase> createParser(const string& kind) {
+    if (kind == "lr0") return make_shared<LR0Parser>();
+    if (kind == "slr1") return make_shared<SLR1Parser>();
+    if (kind == "lalr1") return make_shared<LALR1Parser>();
+    if (kind == "lr1") return make_shared<LR1Parser>();
+    return nullptr;
+}
+
+// 文法注册表：文法ID取自规范化产生式的内容哈希，不同用户/任务的文法互不覆盖
+// 文法源（键为ID）和编译好的分析表（键为 ID/分析器名）放在同一个按字节计量的LRU缓存中，
+// 超出预算时淘汰最久未使用的项；分析表是只读快照，被淘汰后仍在使用它的请求不受影响
+class GrammarRegistry {
+public:
+    explicit GrammarRegistry(size_t budgetBytes) : budget(budgetBytes) {}
+
+    // 注册文法并返回ID；alreadyLoaded表示该文法此前已注册过（无需再做任何构造）
+    string add(const vector<string>& grammar, bool& alreadyLoaded) {
+        // 加载一遍以校验文法并得到规范形式，代价与文法大小成线性
+        auto loaded = make_shared<Grammar>();
+        loaded->load(grammar);
+        string normalized = loaded->normalized();
+
+        ostringstream idStream;
+        idStream << hex << setw(16) << setfill('0') << stringFingerprint(normalized);
+        string id = idStream.str();
+
+        lock_guard<mutex> lock(mtx);
+        auto it = entries.find(id);
+        alreadyLoaded = it != entries.end();
+        if (alreadyLoaded) {
+            if (it->second.normalized != normalized) {
+                throw runtime_error("Grammar ID collision for " + id);
+            }
+            touch(it->second);
+            return id;
+        }
+
+        Entry entry;
+        entry.grammar = loaded;
+        entry.normalized = normalized;
+        entry.bytes = normalized.size();
+        for (const auto& line : grammar) entry.bytes += sizeof(string) + line.size();
+        insert(id, move(entry));
+        return id;
+    }
+
+    bool contains(const string& id) {
+        lock_guard<mutex> lock(mtx);
+        return entries.count(id) > 0;
+    }
+
+    // 登记映射文件上的分析表；映射的内存由操作系统按需换页，不计入缓存预算，也不会被淘汰
+    void addMapped(shared_ptr<const TableView> view) {
+        lock_guard<mutex> lock(mtx);
+        mapped[view->id() + "/" + view->kindName()] = move(view);
+    }
+
+    shared_ptr<const TableView> mappedTable(const string& id, const string& kind) {
+        lock_guard<mutex> lock(mtx);
+        auto it = mapped.find(id + "/" + kind);
+        return it != mapped.end() ? it->second : nullptr;
+    }
+
+    // 启动时加载目录下所有 *.lrt 文件，单个文件出错时记录日志并跳过，返回加载的个数
+    int loadCompiledDirectory(const string& dir) {
+        error_code ec;
+        if (!filesystem::is_directory(dir, ec)) return 0;
+        int loaded = 0;
+        for (const auto& file : filesystem::directory_iterator(dir, ec)) {
+            if (file.path().extension() != ".lrt") continue;
+            try {
+                addMapped(TableView::open(file.path().string()));
+                loaded++;
+            }
+            catch (const exception& e) {
+                cerr << "Skipping compiled grammar: " << e.what() << endl;
+            }
+        }
+        return loaded;
+    }
+
+    // 已缓存的分析表种类
+    vector<string> compiledKinds(const string& id) {
+        lock_guard<mutex> lock(mtx);
+        vector<string> kinds;
+        for (const char* kind : PARSER_KINDS) {
+            if (entries.count(id + "/" + kind) || mapped.count(id + "/" + kind)) kinds.push_back(kind);
+        }
+        return kinds;
+    }
+
+    // 取得编译好的分析表，缓存未命中时在锁外构造；文法未注册（或已被淘汰）时返回空指针
+    shared_ptr<const ParserBase> compiled(const string& id, const string& kind, bool& cached) {
+        string key = id + "/" + kind;
+        shared_ptr<const Grammar> grammar;
+        {
+            lock_guard<mutex> lock(mtx);
+            auto it = entries.find(key);
+            if (it != entries.end()) {
+                cached = true;
+                touch(it->second);
+                auto source = entries.find(id);
+                if (source != entries.end()) touch(source->second);
+                return it->second.parser;
+            }
+            auto source = entries.find(id);
+            if (source == entries.end()) return nullptr;
+            touch(source->second);
+            grammar = source->second.grammar;
+        }
+
+        cached = false;
+        auto parser = createParser(kind);
+        if (!parser) {
+            throw runtime_error("Unknown parser '" + kind + "'");
+        }
+        parser->loadGrammar(grammar);  // 同一文法的各种分析表共享文法和LR(0)自动机
+        parser->buildParseTable();
+
+        lock_guard<mutex> lock(mtx);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            // 其他请求已经构造好同一张表，使用先入缓存的那份
+            touch(it->second);
+            return it->second.parser;
+        }
+        Entry entry;
+        entry.parser = parser;
+        entry.bytes = parser->memoryUsage();
+        insert(key, move(entry));
+        return parser;
+    }
+
+private:
+    struct Entry {
+        shared_ptr<const Grammar> grammar;          // 已加载的文法（仅文法项）
+        string normalized;                          // 规范化文法文本（仅文法项，用于检测哈希冲突）
+        shared_ptr<const ParserBase> parser;        // 编译好的分析表（仅分析表项）
+        size_t bytes = 0;
+        list<string>::iterator lruPos;
+    };
+
+    void touch(Entry& entry) {
+        lru.splice(lru.begin(), lru, entry.lruPos);
+    }
+
+    void insert(const string& key, Entry entry) {
+        lru.push_front(key);
+        entry.lruPos = lru.begin();
+        usedBytes += entry.bytes;
+        entries[key] = move(entry);
+
+        // 淘汰最久未使用的项，刚插入的项总是保留
+        while (usedBytes > budget && lru.size() > 1) {
+            auto victim = entries.find(lru.back());
+            usedBytes -= victim->second.bytes;
+            entries.erase(victim);
+            lru.pop_back();
+        }
+    }
+
+    mutex mtx;
+    size_t budget;
+    size_t usedBytes = 0;
+    list<string> lru;                         // 最近使用的在前
+    unordered_map<string, Entry> entries;
+    unordered_map<string, shared_ptr<const TableView>> mapped;   // 键为 "id/kind"
+};
+
+// 推送式分析会话：客户端分多次请求送入输入，请求之间会话保存分析状态
+struct PushSession {
+    mutex lock;                                   // 串行化同一会话上的请求
+    string grammarId;
+    string kind;
+    unique_ptr<PushParser<ParserBase>> parser;    // 内存中编译好的分析表
+    unique_ptr<PushParser<TableView>> view;       // 只有映射的预编译分析表时
+    chrono::steady_clock::time_point lastUsed;
+
+    // 对会话实际使用的分析器调用f
+    template <typename F>
+    auto visit(F&& f) {
+        return parser ? f(*parser) : f(*view);
+    }
+
+    // 会话当前的分析状态
+    crow::json::wvalue toJson() {
+        return visit([&](auto& pushParser) {
+            crow::json::wvalue json = ParserBase::toJson(pushParser.status());
+            json["finished"] = pushParser.finished();
+            json["tokens_consumed"] = pushParser.tokensConsumed();
+            json["stack_depth"] = pushParser.stackDepth();
+            json["id"] = grammarId;
+            json["parser"] = kind;
+            return json;
+        });
+    }
+};
+
+// 增量分析会话：编辑器每次只提交编辑，会话保存上次的语法树
+struct ReparseSession {
+    mutex lock;
+    string parserType;
+    IncrementalParser parser;
+    chrono::steady_clock::time_point lastUsed;
+
+    ReparseSession(const string& type, shared_ptr<const ParserBase> tables)
+        : parserType(type), parser(move(tables)) {}
+
+    // 一次分析的结果；withTree为true时附带整棵语法树（大小与输入成正比）
+    crow::json::wvalue toJson(const IncrementalParser::Stats& stats, bool withTree) const {
+        crow::json::wvalue json = IncrementalParser::toJson(stats);
+        json["parser_type"] = parserType;
+        json["token_count"] = parser.numTokens();
+        if (withTree) json["tree"] = parser.treeToJson();
+        return json;
+    }
+};
+
+// 会话表：Session需要有lastUsed成员；超过空闲时限的会话在打开新会话时清理
+template <typename Session>
+class SessionTable {
+public:
+    SessionTable(size_t maxSessions, chrono::seconds idleTimeout)
+        : maxSessions(maxSessions), idleTimeout(idleTimeout) {}
+
+    // 登记新会话，返回会话ID；会话数已达上限时返回-1
+    int open(shared_ptr<Session> session) {
+        lock_guard<mutex> lock(mtx);
+        auto now = chrono::steady_clock::now();
+        for (auto it = sessions.begin(); it != sessions.end();) {
+            if (now - it->second->lastUsed > idleTimeout) it = sessions.erase(it);
+            else ++it;
+        }
+        if (sessions.size() >= maxSessions) return -1;
+
+        session->lastUsed = now;
+        int id = nextId++;
+        sessions[id] = move(session);
+        return id;
+    }
+
+    shared_ptr<Session> find(int id) {
+        lock_guard<mutex> lock(mtx);
+        auto it = sessions.find(id);
+        if (it == sessions.end()) return nullptr;
+        it->second->lastUsed = chrono::steady_clock::now();
+        return it->second;
+    }
+
+    bool close(int id) {
+        lock_guard<mutex> lock(mtx);
+        return sessions.erase(id) > 0;
+    }
+
+private:
+    mutex mtx;
+    unordered_map<int, shared_ptr<Session>> sessions;
+    int nextId = 1;
+    size_t maxSessions;
+    chrono::seconds idleTimeout;
+};
+
+// 命令行模式：backend --export-cpp <文法文件> [--parser slr1] [--style table|direct] [--namespace 名字] [-o 输出文件]
+// 文法文件每行与 /api/load_grammar 的grammar数组中的一项相同，不指定-o时输出到标准输出
+int runExportCpp(int argc, char* argv[]) {
+    string grammarPath, kind = "slr1", style = "table", nameSpace = "generated_parser", outputPath;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cerr << "Missing value for " << arg << endl;
+            return 2;
+        }
+        string value = argv[++i];
+        if (arg == "--export-cpp") grammarPath = value;
+        else if (arg == "--parser") kind = value;
+        else if (arg == "--style") style = value;
+        else if (arg == "--namespace") nameSpace = value;
+        else if (arg == "-o") outputPath = value;
+        else {
+            cerr << "Unknown option " << arg << endl;
+            return 2;
+        }
+    }
+
+    try {
+        ifstream in(grammarPath);
+        if (!in) throw runtime_error("Cannot open '" + grammarPath + "'");
+        vector<string> grammar;
+        string line;
+        while (getline(in, line)) grammar.push_back(line);
+
+        auto parser = createParser(kind);
+        if (!parser) throw runtime_error("Unknown parser '" + kind + "'");
+        // 构造分析表时的冲突信息输出到标准错误，以免混入生成的代码
+        streambuf* savedCout = cout.rdbuf(cerr.rdbuf());
+        try {
+            parser->loadGrammar(grammar);
+            parser->buildParseTable();
+        }
+        catch (...) {
+            cout.rdbuf(savedCout);
+            throw;
+        }
+        cout.rdbuf(savedCout);
+        string header = CppGenerator::generate(*parser, nameSpace, style);
+
+        if (outputPath.empty()) {
+            cout << header;
+        } else {
+            ofstream out(outputPath, ios::trunc);
+            if (!out || !(out << header)) throw runtime_error("Cannot write '" + outputPath + "'");
+        }
+        return 0;
+    }
+    catch (const exception& e) {
+        cerr << "Error exporting parser: " << e.what() << endl;
+        return 1;
+    }
+}
+
+// 测试程序（tests/）直接包含本文件并定义BACKEND_NO_MAIN，只使用其中的分析器
+#ifndef BACKEND_NO_MAIN
+// /api/parse_input* 的共同处理：用slot分析请求中的输入串
+// trace为false时只做识别，不返回分析步骤；output为reductions/reductions_base64时只返回规约序列
+crow::response parseInputResponse(ParserSlot& slot, const crow::request& req) {
+    auto body = crow::json::load(req.body);
+    if (!body || !body.has("input")) {
+        return crow::response(400, "Invalid JSON or missing 'input' field");
+    }
+
+    try {
+        string input = body["input"].s();
+        bool trace = !body.has("trace") || body["trace"].b();
+        bool inlineSteps = !body.has("inline_steps") || body["inline_steps"].b();
+        string output = body.has("output") ? string(body["output"].s()) : "steps";
+        if (!ParserBase::isOutputMode(output)) {
+            return crow::response(400, "Unknown output mode '" + output + "'");
+        }
+        crow::response res(slot.parse(input, trace, inlineSteps, output));
+        res.add_header("Content-Type", "application/json");
+        return res;
+    }
+    catch (const exception& e) {
+        return crow::response(500, "Error parsing input with " + slot.typeName + ": " + e.what());
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return runExportCpp(argc, argv);
+    }
+
+    // 使用中间件创建应用
+    crow::App<CORSMiddleware> app;
+
+    // 带轨迹分析的轨迹缓存，上限128MB，供 /api/parse_steps 按trace_id读取
+    TraceStore traceStore(128u << 20);
+
+    ParserSlot lr0Slot("LR(0)", [] { return make_shared<LR0Parser>(); }, traceStore);
+    ParserSlot slr1Slot("SLR(1)", [] { return make_shared<SLR1Parser>(); }, traceStore);
+    ParserSlot lalr1Slot("LALR(1)", [] { return make_shared<LALR1Parser>(); }, traceStore);
+    ParserSlot lr1Slot("LR(1)", [] { return make_shared<LR1Parser>(); }, traceStore);
+    ParserSlot glrSlot("GLR", [] { return make_shared<GLRParser>(); }, traceStore);
+    vector<ParserSlot*> allSlots = { &lr0Slot, &slr1Slot, &lalr1Slot, &lr1Slot, &glrSlot };
+
+    // 按种类名（请求中的 "parser" 字段）查找确定性分析器（PARSER_KINDS），未知名字返回空指针
+    auto slotByName = [&allSlots](const string& kind) -> ParserSlot* {
+        for (ParserSlot* slot : allSlots) {
+            if (slot->kind != kind) continue;
+            for (const char* known : PARSER_KINDS) {
+                if (kind == known) return slot;
+            }
+        }
+        return nullptr;
+    };
+
+    // 多文法注册表，编译缓存上限256MB
+    GrammarRegistry registry(256u << 20);
+
+    // 推送式分析会话和增量分析会话，各最多同时打开1024个，空闲10分钟后清理
+    SessionTable<PushSession> pushSessions(1024, chrono::minutes(10));
+    SessionTable<ReparseSession> reparseSessions(1024, chrono::minutes(10));
+
+    // 批量识别的工作线程池，所有/api/parse_batch请求共用（请求线程自身也参与，故少建一个）
+    WorkerPool batchPool(max(1u, thread::hardware_concurrency()) - 1);
+
+    // 预编译的分析表目录（环境变量COMPILED_GRAMMAR_DIR，默认为compiled_grammars），启动时全部映射
+    const char* compiledDirEnv = getenv("COMPILED_GRAMMAR_DIR");
+    string compiledDir = compiledDirEnv ? compiledDirEnv : "compiled_grammars";
+    int mappedCount = registry.loadCompiledDirectory(compiledDir);
+    if (mappedCount > 0) {
+        cout << "Mapped " << mappedCount << " compiled grammar(s) from " << compiledDir << endl;
+    }
+
+    // API端点：加载文法
+    CROW_ROUTE(app, "/api/load_grammar")
+        .methods("POST"_method)
+        ([&allSlots](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            if (!body) {
+                return crow::response(400, "Invalid JSON");
+            }
+
+            vector<string> grammar;
+            for (const auto& line : body["grammar"]) {
+                grammar.push_back(line.s());
+            }
+
+            try {
+                // 文法只加载一次，各分析器共享（LR(0)自动机也随之共享）
+                // 全部成功后再发布，出错时保留原有快照
+                auto shared = make_shared<Grammar>();
+                shared->load(grammar);
+                vector<shared_ptr<ParserBase>> loaded;
+                for (ParserSlot* slot : allSlots) {
+                    loaded.push_back(slot->create());
+                    loaded.back()->loadGrammar(shared);
+                }
+                for (size_t i = 0; i < allSlots.size(); i++) {
+                    lock_guard<mutex> lock(allSlots[i]->writeMutex);
+                    allSlots[i]->publish(loaded[i]);
+                }
+                return crow::response(200, "Grammar loaded successfully");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error loading grammar: ") + e.what());
+            }
+        });
+
+    // API端点：构建LR(0)分析表
+    CROW_ROUTE(app, "/api/build_lr0_table")
+        .methods("GET"_method)
+        ([&lr0Slot] {
+            try {
+                lr0Slot.rebuild();
+                return crow::response(200, "LR(0) Parse table built successfully");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error building LR(0) parse table: ") + e.what());
+            }
+        });
+
+    // API端点：构建SLR(1)分析表
+    CROW_ROUTE(app, "/api/build_table")
+        .methods("GET"_method)
+        ([&slr1Slot] {
+            try {
+                slr1Slot.rebuild();
+                return crow::response(200, "SLR(1) Parse table built successfully");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error building SLR(1) parse table: ") + e.what());
+            }
+        });
+
+    // API端点：构建LALR(1)分析表
+    CROW_ROUTE(app, "/api/build_lalr1_table")
+        .methods("GET"_method)
+        ([&lalr1Slot] {
+            try {
+                lalr1Slot.rebuild();
+                return crow::response(200, "LALR(1) Parse table built successfully");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error building LALR(1) parse table: ") + e.what());
+            }
+        });
+
+    // API端点：构建LR(1)分析表，返回状态数、合并数和不合并时的状态数
+    CROW_ROUTE(app, "/api/build_lr1_table")
+        .methods("GET"_method)
+        ([&lr1Slot] {
+            try {
+                auto parser = lr1Slot.rebuild();
+                return crow::response(200, "LR(1) Parse table built successfully (states: " +
+                    to_string(parser->automaton->itemSets.size()) + ", states merged: " +
+                    to_string(parser->lr1StatesMerged) + ", states without merging: " +
+                    to_string(parser->lr1ItemSetsBuilt + parser->lr1StatesMerged) + ")");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error building LR(1) parse table: ") + e.what());
+            }
+        });
+
+    // API端点：构建GLR分析表（LALR(1)向前看，保留全部冲突），返回冲突表项数
+    CROW_ROUTE(app, "/api/build_glr_table")
+        .methods("GET"_method)
+        ([&glrSlot] {
+            try {
+                auto parser = static_pointer_cast<const GLRParser>(glrSlot.rebuild());
+                return crow::response(200, "GLR Parse table built successfully (conflicting entries: " +
+                    to_string(parser->conflictActions.size()) + ")");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error building GLR parse table: ") + e.what());
+            }
+        });
+
+    // API端点：清理缓存
+    CROW_ROUTE(app, "/api/clear_cache")
+        .methods("POST"_method)
+        ([&allSlots] {
+            try {
+                for (ParserSlot* slot : allSlots) {
+                    lock_guard<mutex> lock(slot->writeMutex);
+                    slot->publish(slot->create());
+                }
+                return crow::response(200, "Cache cleared successfully");
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error clearing cache: ") + e.what());
+            }
+        });
+
+    // API端点：获取LR(0)分析表数据
+    CROW_ROUTE(app, "/api/get_lr0_table_data")
+        .methods("GET"_method)
+        ([&lr0Slot] {
+            try {
+                crow::response res(lr0Slot.toJson());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error getting LR(0) table data: ") + e.what());
+            }
+        });
+
+    // API端点：获取SLR(1)分析表数据
+    CROW_ROUTE(app, "/api/get_table_data")
+        .methods("GET"_method)
+        ([&slr1Slot] {
+            try {
+                crow::response res(slr1Slot.toJson());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error getting SLR(1) table data: ") + e.what());
+            }
+        });
+
+    // API端点：获取LALR(1)分析表数据
+    CROW_ROUTE(app, "/api/get_lalr1_table_data")
+        .methods("GET"_method)
+        ([&lalr1Slot] {
+            try {
+                crow::response res(lalr1Slot.toJson());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error getting LALR(1) table data: ") + e.what());
+            }
+        });
+
+    // API端点：获取LR(1)分析表数据
+    CROW_ROUTE(app, "/api/get_lr1_table_data")
+        .methods("GET"_method)
+        ([&lr1Slot] {
+            try {
+                crow::response res(lr1Slot.toJson());
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error getting LR(1) table data: ") + e.what());
+            }
+        });
+
+    // API端点：使用LR(0)分析输入字符串（见parseInputResponse）
+    CROW_ROUTE(app, "/api/parse_input_lr0")
+        .methods("POST"_method)
+        ([&lr0Slot](const crow::request& req) {
+            return parseInputResponse(lr0Slot, req);
+        });
+
+    // API端点：使用SLR(1)分析输入字符串（见parseInputResponse）
+    CROW_ROUTE(app, "/api/parse_input")
+        .methods("POST"_method)
+        ([&slr1Slot](const crow::request& req) {
+            return parseInputResponse(slr1Slot, req);
+        });
+
+    // API端点：使用LALR(1)分析输入字符串（见parseInputResponse）
+    CROW_ROUTE(app, "/api/parse_input_lalr1")
+        .methods("POST"_method)
+        ([&lalr1Slot](const crow::request& req) {
+            return parseInputResponse(lalr1Slot, req);
+        });
+
+    // API端点：使用LR(1)分析输入字符串（见parseInputResponse）
+    CROW_ROUTE(app, "/api/parse_input_lr1")
+        .methods("POST"_method)
+        ([&lr1Slot](const crow::request& req) {
+            return parseInputResponse(lr1Slot, req);
+        });
+
+    // API端点：GLR分析，返回共享压缩分析森林，如 {"input": "id + id + id", "forest": true}
+    CROW_ROUTE(app, "/api/parse_glr")
+        .methods("POST"_method)
+        ([&glrSlot](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            if (!body || !body.has("input")) {
+                return crow::response(400, "Invalid JSON or missing 'input' field");
+            }
+
+            try {
+                auto parser = static_pointer_cast<const GLRParser>(glrSlot.snapshot());
+                bool buildForest = !body.has("forest") || body["forest"].b();
+                auto json = parser->forestToJson(parser->glrParse(body["input"].s(), buildForest));
+                json["conflicts"] = static_cast<int>(parser->conflictActions.size());
+                json["parser_type"] = glrSlot.typeName;
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error parsing input with GLR: ") + e.what());
+            }
+        });
 
-private:
-    // 辅助函数：将栈转为字符串（状态栈）
-    string stackToString(stack<int> stk) {
-        string result;
-        stack<int> temp;
-        while (!stk.empty()) {
-            temp.push(stk.top());
-            stk.pop();
-        }
-        while (!temp.empty()) {
-            result += to_string(temp.top()) + " ";
-            temp.pop();
-        }
-        return result;
-    }
+    // API端点：批量分析输入字符串，如 {"parser": "lalr1", "inputs": ["id + id", "id *"]}
+    CROW_ROUTE(app, "/api/parse_batch")
+        .methods("POST"_method)
+        ([&slotByName, &batchPool](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            if (!body || !body.has("inputs") || body["inputs"].t() != crow::json::type::List) {
+                return crow::response(400, "Invalid JSON or missing 'inputs' array");
+            }
 
-    // 辅助函数：将栈转为字符串（符号栈）
-    string stackToString(stack<string> stk) {
-        string result;
-        stack<string> temp;
-        while (!stk.empty()) {
-            temp.push(stk.top());
-            stk.pop();
-        }
-        while (!temp.empty()) {
-            result += temp.top() + " ";
-            temp.pop();
-        }
-        return result;
-    }
+            // 选择分析器，默认为SLR(1)
+            string parserName = body.has("parser") ? string(body["parser"].s()) : "slr1";
+            ParserSlot* slot = slotByName(parserName);
+            if (!slot) {
+                return crow::response(400, "Unknown parser '" + parserName + "'");
+            }
 
-    // 辅助函数：获取剩余输入字符串
-    string getRemainingInput(const vector<string>& tokens, size_t pos) {
-        string result;
-        for (size_t i = pos; i < tokens.size(); ++i) {
-            result += tokens[i];
-            if (i < tokens.size() - 1) result += " ";
-        }
-        return result;
-    }
-};
+            try {
+                vector<string> inputs;
+                for (const auto& input : body["inputs"]) {
+                    inputs.push_back(input.s());
+                }
 
-// LR(0)语法分析器类
-class LR0Parser : public ParserBase {
-public:
-    void buildParseTable() {
-        buildLR0ParseTable();
-    }
-};
+                // 整批输入使用同一个快照，期间发布的新分析表不影响本批结果
+                vector<ParserBase::RecognizeResult> results = slot->snapshot()->recognizeBatch(inputs, batchPool);
 
-// SLR(1)语法分析器类  
-class SLR1Parser : public ParserBase {
-public:
-    void buildParseTable() {
-        buildSLR1ParseTable();
-    }
-};
+                int acceptedCount = 0;
+                vector<crow::json::wvalue> resultJson;
+                for (const auto& r : results) {
+                    if (r.accepted) acceptedCount++;
+                    resultJson.push_back(ParserBase::toJson(r));
+                }
 
-// 解决CORS问题的中间件
-struct CORSMiddleware {
-    struct context {};
-    
-    void before_handle(crow::request& req, crow::response& res, context& ctx) {
-        // 设置CORS头
-        res.add_header("Access-Control-Allow-Origin", "*");
-        res.add_header("Access-Control-Allow-Headers", "Content-Type");
-        
-        // 处理OPTIONS预检请求
-        if (req.method == crow::HTTPMethod::Options) {
-            res.code = crow::OK;
-            res.end();
-        }
-    }
-    
-    void after_handle(crow::request& req, crow::response& res, context& ctx) {}
-};
+                crow::json::wvalue json;
+                json["parser_type"] = slot->typeName;
+                json["accepted_count"] = acceptedCount;
+                json["results"] = move(resultJson);
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error parsing batch: ") + e.what());
+            }
+        });
 
-int main() {
-    // 使用中间件创建应用
-    crow::App<CORSMiddleware> app;
+    // API端点：按窗口读取分析步骤，如 /api/parse_steps?trace=3&from=1000&count=50
+    CROW_ROUTE(app, "/api/parse_steps")
+        .methods("GET"_method)
+        ([&traceStore](const crow::request& req) {
+            const char* traceParam = req.url_params.get("trace");
+            const char* fromParam = req.url_params.get("from");
+            const char* countParam = req.url_params.get("count");
+            if (!traceParam) {
+                return crow::response(400, "Missing 'trace' parameter");
+            }
 
-    LR0Parser lr0Parser;
-    SLR1Parser slr1Parser;
+            try {
+                int id = stoi(traceParam);
+                long long from = fromParam ? stoll(fromParam) : 0;
+                long long count = countParam ? stoll(countParam) : 100;
+                if (from < 0 || count < 0) {
+                    return crow::response(400, "'from' and 'count' must be non-negative");
+                }
 
-    // API端点：加载文法
-    CROW_ROUTE(app, "/api/load_grammar")
+                auto traced = traceStore.find(id);
+                if (!traced) {
+                    return crow::response(404, "Trace not found, evicted, or its grammar was replaced");
+                }
+                crow::json::wvalue json;
+                json["trace_id"] = id;
+                json["step_count"] = static_cast<int>(traced->trace.ops.size());
+                json["from"] = static_cast<int>(from);
+                json["parse_steps"] = ParserBase::toJson(traced->compiled->parseStepsWindow(traced->trace, from, count));
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error reading parse steps: ") + e.what());
+            }
+        });
+
+    // API端点：注册文法，返回按内容哈希得到的文法ID；同一文法重复注册时直接返回
+    CROW_ROUTE(app, "/api/grammars")
         .methods("POST"_method)
-        ([&lr0Parser, &slr1Parser](const crow::request& req) {
+        ([&registry](const crow::request& req) {
             auto body = crow::json::load(req.body);
-            if (!body) {
-                return crow::response(400, "Invalid JSON");
+            if (!body || !body.has("grammar")) {
+                return crow::response(400, "Invalid JSON or missing 'grammar' field");
             }
 
             vector<string> grammar;
@@ -936,135 +4402,422 @@ int main() {
             }
 
             try {
-                // 清理之前的缓存数据
-                lr0Parser.clearCache();
-                slr1Parser.clearCache();
-                
-                lr0Parser.loadGrammar(grammar);
-                slr1Parser.loadGrammar(grammar);
-                return crow::response(200, "Grammar loaded successfully");
+                bool alreadyLoaded = false;
+                string id = registry.add(grammar, alreadyLoaded);
+
+                crow::json::wvalue json;
+                json["id"] = id;
+                json["already_loaded"] = alreadyLoaded;
+                json["compiled"] = registry.compiledKinds(id);
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
             }
             catch (const exception& e) {
                 return crow::response(500, string("Error loading grammar: ") + e.what());
             }
         });
 
-    // API端点：构建LR(0)分析表
-    CROW_ROUTE(app, "/api/build_lr0_table")
-        .methods("GET"_method)
-        ([&lr0Parser] {
+    // API端点：为已注册的文法构造分析表，如 {"parser": "lalr1"}，默认为SLR(1)；已缓存时直接返回
+    CROW_ROUTE(app, "/api/grammars/<string>/build")
+        .methods("POST"_method)
+        ([&registry](const crow::request& req, string id) {
+            auto body = crow::json::load(req.body);
+            string kind = body && body.has("parser") ? string(body["parser"].s()) : "slr1";
+
             try {
-                lr0Parser.buildParseTable();
-                return crow::response(200, "LR(0) Parse table built successfully");
+                crow::json::wvalue json;
+                json["id"] = id;
+                json["parser"] = kind;
+                if (auto view = registry.mappedTable(id, kind)) {
+                    // 已有预编译的分析表，无需构造
+                    json["cached"] = true;
+                    json["mapped"] = true;
+                    json["states"] = view->numStates();
+                    crow::response res(json);
+                    res.add_header("Content-Type", "application/json");
+                    return res;
+                }
+
+                bool cached = false;
+                auto parser = registry.compiled(id, kind, cached);
+                if (!parser) {
+                    return crow::response(404, "Grammar '" + id + "' not found");
+                }
+
+                json["cached"] = cached;
+                json["mapped"] = false;
+                json["states"] = static_cast<int>(parser->automaton->itemSets.size());
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error building LR(0) parse table: ") + e.what());
+                return crow::response(500, string("Error building parse table: ") + e.what());
             }
         });
 
-    // API端点：构建SLR(1)分析表
-    CROW_ROUTE(app, "/api/build_table")
-        .methods("GET"_method)
-        ([&slr1Parser] {
+    // API端点：用已注册文法的分析表分析输入串（需要时先构造分析表），trace为false时只做识别，
+    // output为reductions/reductions_base64时只返回规约序列
+    CROW_ROUTE(app, "/api/grammars/<string>/parse")
+        .methods("POST"_method)
+        ([&registry](const crow::request& req, string id) {
+            auto body = crow::json::load(req.body);
+            if (!body || !body.has("input")) {
+                return crow::response(400, "Invalid JSON or missing 'input' field");
+            }
+            string kind = body.has("parser") ? string(body["parser"].s()) : "slr1";
+            string output = body.has("output") ? string(body["output"].s()) : "steps";
+            if (!ParserBase::isOutputMode(output)) {
+                return crow::response(400, "Unknown output mode '" + output + "'");
+            }
+            bool reductionsOnly = output != "steps";
+            bool withTrace = !reductionsOnly && (!body.has("trace") || body["trace"].b());
+
             try {
-                slr1Parser.buildParseTable();
-                return crow::response(200, "SLR(1) Parse table built successfully");
+                string input = body["input"].s();
+                crow::json::wvalue json;
+                vector<int> sequence;
+
+                // 只做识别或只要规约序列时优先使用映射的预编译分析表
+                auto view = withTrace ? nullptr : registry.mappedTable(id, kind);
+                if (view) {
+                    if (reductionsOnly) {
+                        auto result = ParserBase::reductionsWith(*view, input, sequence);
+                        json = ParserBase::toJson(result, sequence, output == "reductions_base64");
+                    } else {
+                        json = ParserBase::toJson(ParserBase::recognizeWith(*view, input));
+                    }
+                    json["id"] = id;
+                    json["parser"] = kind;
+                    crow::response res(json);
+                    res.add_header("Content-Type", "application/json");
+                    return res;
+                }
+
+                bool cached = false;
+                auto parser = registry.compiled(id, kind, cached);
+                if (!parser) {
+                    if (registry.mappedTable(id, kind)) {
+                        return crow::response(400, "Grammar '" + id + "' is only available precompiled; set 'trace' to false");
+                    }
+                    return crow::response(404, "Grammar '" + id + "' not found");
+                }
+
+                if (reductionsOnly) {
+                    auto result = parser->reductions(input, sequence);
+                    json = ParserBase::toJson(result, sequence, output == "reductions_base64");
+                } else if (withTrace) {
+                    ParserBase::ParseTrace trace;
+                    parser->parse(input, trace);
+                    json = parser->toJson(&trace);
+                    json["step_count"] = static_cast<int>(trace.ops.size());
+                } else {
+                    json = ParserBase::toJson(parser->recognize(input));
+                }
+                json["id"] = id;
+                json["parser"] = kind;
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error building SLR(1) parse table: ") + e.what());
+                return crow::response(500, string("Error parsing input: ") + e.what());
             }
         });
 
-    // API端点：清理缓存
-    CROW_ROUTE(app, "/api/clear_cache")
+    // API端点：把已注册文法的分析表保存到预编译目录，如 {"parser": "lalr1", "item_sets": true}
+    // 文件名为 <id>.<parser>.lrt，下次启动时自动映射
+    CROW_ROUTE(app, "/api/grammars/<string>/save")
         .methods("POST"_method)
-        ([&lr0Parser, &slr1Parser] {
+        ([&registry, &compiledDir](const crow::request& req, string id) {
+            auto body = crow::json::load(req.body);
+            string kind = body && body.has("parser") ? string(body["parser"].s()) : "slr1";
+            bool withItemSets = body && body.has("item_sets") && body["item_sets"].b();
+
             try {
-                lr0Parser.clearCache();
-                slr1Parser.clearCache();
-                return crow::response(200, "Cache cleared successfully");
+                bool cached = false;
+                auto parser = registry.compiled(id, kind, cached);
+                if (!parser) {
+                    return crow::response(404, "Grammar '" + id + "' not found");
+                }
+
+                filesystem::create_directories(compiledDir);
+                string path = (filesystem::path(compiledDir) / (id + "." + kind + ".lrt")).string();
+                parser->saveCompiled(path, withItemSets);
+                registry.addMapped(TableView::open(path));
+
+                crow::json::wvalue json;
+                json["id"] = id;
+                json["parser"] = kind;
+                json["path"] = path;
+                json["bytes"] = static_cast<int64_t>(filesystem::file_size(path));
+                crow::response res(json);
+                res.add_header("Content-Type", "application/json");
+                return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error clearing cache: ") + e.what());
+                return crow::response(500, string("Error saving parse table: ") + e.what());
             }
         });
 
-    // API端点：获取LR(0)分析表数据
-    CROW_ROUTE(app, "/api/get_lr0_table_data")
-        .methods("GET"_method)
-        ([&lr0Parser] {
+    // API端点：把当前文法的分析表导出为独立的C++头文件，如 {"parser": "lalr1", "namespace": "expr"}
+    // style为 "table"（默认，表驱动）或 "direct"（直接编码）
+    CROW_ROUTE(app, "/api/export_cpp")
+        .methods("POST"_method)
+        ([&slotByName](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            string parserName = body && body.has("parser") ? string(body["parser"].s()) : "slr1";
+            string nameSpace = body && body.has("namespace") ? string(body["namespace"].s()) : "generated_parser";
+            string style = body && body.has("style") ? string(body["style"].s()) : "table";
+            ParserSlot* slot = slotByName(parserName);
+            if (!slot) {
+                return crow::response(400, "Unknown parser '" + parserName + "'");
+            }
+
+            try {
+                crow::response res(CppGenerator::generate(*slot->snapshot(), nameSpace, style));
+                res.add_header("Content-Type", "text/x-c++hdr; charset=utf-8");
+                res.add_header("Content-Disposition", "attachment; filename=\"" + CppGenerator::identifier(nameSpace) + ".h\"");
+                return res;
+            }
+            catch (const exception& e) {
+                return crow::response(500, string("Error exporting parser: ") + e.what());
+            }
+        });
+
+    // API端点：打开推送式分析会话，如 {"grammar_id": "...", "parser": "lalr1"}，返回session_id
+    // 之后分多次请求送入输入，最后调用finish取得结果；会话之间可以任意暂停
+    CROW_ROUTE(app, "/api/push_sessions")
+        .methods("POST"_method)
+        ([&registry, &pushSessions](const crow::request& req) {
+            auto body = crow::json::load(req.body);
+            if (!body || !body.has("grammar_id")) {
+                return crow::response(400, "Invalid JSON or missing 'grammar_id' field");
+            }
+            string id = body["grammar_id"].s();
+            string kind = body.has("parser") ? string(body["parser"].s()) : "slr1";
+
             try {
-                auto json = lr0Parser.toJson();
-                json["parser_type"] = "LR(0)";
+                auto session = make_shared<PushSession>();
+                session->grammarId = id;
+                session->kind = kind;
+                // 优先使用映射的预编译分析表
+                if (auto view = registry.mappedTable(id, kind)) {
+                    session->view = make_unique<PushParser<TableView>>(view);
+                } else {
+                    bool cached = false;
+                    auto parser = registry.compiled(id, kind, cached);
+                    if (!parser) {
+                        return crow::response(404, "Grammar '" + id + "' not found");
+                    }
+                    session->parser = make_unique<PushParser<ParserBase>>(parser);
+                }
+
+                int sessionId = pushSessions.open(session);
+                if (sessionId < 0) {
+                    return crow::response(503, "Too many open push sessions");
+                }
+                auto json = session->toJson();
+                json["session_id"] = sessionId;
                 crow::response res(json);
                 res.add_header("Content-Type", "application/json");
                 return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error getting LR(0) table data: ") + e.what());
+                return crow::response(500, string("Error opening push session: ") + e.what());
             }
         });
 
-    // API端点：获取SLR(1)分析表数据
-    CROW_ROUTE(app, "/api/get_table_data")
+    // API端点：查询会话的分析状态，断线后可据tokens_consumed从中断处继续送入
+    CROW_ROUTE(app, "/api/push_sessions/<int>")
         .methods("GET"_method)
-        ([&slr1Parser] {
+        ([&pushSessions](int sessionId) {
+            auto session = pushSessions.find(sessionId);
+            if (!session) {
+                return crow::response(404, "Push session not found or expired");
+            }
+            lock_guard<mutex> lock(session->lock);
+            crow::response res(session->toJson());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        });
+
+    // API端点：向会话送入一块输入。JSON请求体 {"tokens": ["id", "+"]} 逐个送入完整的符号；
+    // 其他请求体按原始文本切分，块末尾未以空格结束的符号与下一块拼接
+    CROW_ROUTE(app, "/api/push_sessions/<int>/feed")
+        .methods("POST"_method)
+        ([&pushSessions](const crow::request& req, int sessionId) {
+            auto session = pushSessions.find(sessionId);
+            if (!session) {
+                return crow::response(404, "Push session not found or expired");
+            }
+
             try {
-                auto json = slr1Parser.toJson();
-                json["parser_type"] = "SLR(1)";
-                crow::response res(json);
+                lock_guard<mutex> lock(session->lock);
+                if (req.get_header_value("Content-Type").find("application/json") != string::npos) {
+                    auto body = crow::json::load(req.body);
+                    if (!body || !body.has("tokens") || body["tokens"].t() != crow::json::type::List) {
+                        return crow::response(400, "Invalid JSON or missing 'tokens' list");
+                    }
+                    vector<string> tokens;
+                    for (const auto& token : body["tokens"]) {
+                        tokens.push_back(token.s());
+                    }
+                    session->visit([&](auto& parser) { return parser.feed(tokens); });
+                } else {
+                    session->visit([&](auto& parser) { return parser.feedText(req.body); });
+                }
+                crow::response res(session->toJson());
                 res.add_header("Content-Type", "application/json");
                 return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error getting SLR(1) table data: ") + e.what());
+                return crow::response(500, string("Error feeding push session: ") + e.what());
             }
         });
 
-    // API端点：使用LR(0)分析输入字符串
-    CROW_ROUTE(app, "/api/parse_input_lr0")
+    // API端点：结束输入，返回识别结果并关闭会话
+    CROW_ROUTE(app, "/api/push_sessions/<int>/finish")
+        .methods("POST"_method)
+        ([&pushSessions](int sessionId) {
+            auto session = pushSessions.find(sessionId);
+            if (!session) {
+                return crow::response(404, "Push session not found or expired");
+            }
+            lock_guard<mutex> lock(session->lock);
+            session->visit([](auto& parser) { return parser.finish(); });
+            pushSessions.close(sessionId);
+            crow::response res(session->toJson());
+            res.add_header("Content-Type", "application/json");
+            return res;
+        });
+
+    // API端点：放弃会话
+    CROW_ROUTE(app, "/api/push_sessions/<int>/close")
+        .methods("POST"_method)
+        ([&pushSessions](int sessionId) {
+            if (!pushSessions.close(sessionId)) {
+                return crow::response(404, "Push session not found or expired");
+            }
+            return crow::response(200, "Push session closed");
+        });
+
+    // API端点：打开增量分析会话并做第一次完整分析，如 {"parser": "slr1", "input": "id + id", "tree": true}
+    // 分析表取自对应分析器当前的快照，会话期间重新构造分析表不影响该会话
+    CROW_ROUTE(app, "/api/reparse_sessions")
         .methods("POST"_method)
-        ([&lr0Parser](const crow::request& req) {
+        ([&slotByName, &reparseSessions](const crow::request& req) {
             auto body = crow::json::load(req.body);
             if (!body || !body.has("input")) {
                 return crow::response(400, "Invalid JSON or missing 'input' field");
             }
 
+            string parserName = body.has("parser") ? string(body["parser"].s()) : "slr1";
+            ParserSlot* slot = slotByName(parserName);
+            if (!slot) {
+                return crow::response(400, "Unknown parser '" + parserName + "'");
+            }
+
             try {
-                string input = body["input"].s();
-                lr0Parser.parse(input);
-                auto json = lr0Parser.toJson();
-                json["parser_type"] = "LR(0)";
+                auto session = make_shared<ReparseSession>(slot->typeName, slot->snapshot());
+                auto stats = session->parser.edit(0, 0, Grammar::split(body["input"].s(), ' '));
+                int sessionId = reparseSessions.open(session);
+                if (sessionId < 0) {
+                    return crow::response(503, "Too many open reparse sessions");
+                }
+                auto json = session->toJson(stats, body.has("tree") && body["tree"].b());
+                json["session_id"] = sessionId;
                 crow::response res(json);
                 res.add_header("Content-Type", "application/json");
                 return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error parsing input with LR(0): ") + e.what());
+                return crow::response(500, string("Error opening reparse session: ") + e.what());
             }
         });
 
-    // API端点：使用SLR(1)分析输入字符串
-    CROW_ROUTE(app, "/api/parse_input")
+    // API端点：提交一次编辑并增量重新分析，如 {"start": 4, "end": 5, "tokens": ["(", "id", ")"], "tree": false}
+    // start/end为被替换的输入符号下标范围，也可以用 "text" 给出以空格分隔的替换内容
+    CROW_ROUTE(app, "/api/reparse_sessions/<int>/edit")
         .methods("POST"_method)
-        ([&slr1Parser](const crow::request& req) {
+        ([&reparseSessions](const crow::request& req, int sessionId) {
             auto body = crow::json::load(req.body);
-            if (!body || !body.has("input")) {
-                return crow::response(400, "Invalid JSON or missing 'input' field");
+            if (!body || !body.has("start") || !body.has("end")
+                || body["start"].t() != crow::json::type::Number || body["end"].t() != crow::json::type::Number) {
+                return crow::response(400, "Invalid JSON or missing 'start'/'end' fields");
+            }
+            if (body.has("tokens") && body["tokens"].t() != crow::json::type::List) {
+                return crow::response(400, "'tokens' must be a list");
+            }
+            if (!body.has("tokens") && body.has("text") && body["text"].t() != crow::json::type::String) {
+                return crow::response(400, "'text' must be a string");
+            }
+            auto session = reparseSessions.find(sessionId);
+            if (!session) {
+                return crow::response(404, "Reparse session not found or expired");
             }
 
             try {
-                string input = body["input"].s();
-                slr1Parser.parse(input);
-                auto json = slr1Parser.toJson();
-                json["parser_type"] = "SLR(1)";
-                crow::response res(json);
+                vector<string> replacement;
+                if (body.has("tokens")) {
+                    for (const auto& token : body["tokens"]) {
+                        if (token.t() != crow::json::type::String) {
+                            return crow::response(400, "'tokens' must contain only strings");
+                        }
+                        replacement.push_back(token.s());
+                    }
+                } else if (body.has("text")) {
+                    replacement = Grammar::split(body["text"].s(), ' ');
+                }
+
+                // 编辑范围须在会话当前的输入内；在锁内检查，避免与并发的编辑交错。
+                // 先按int64比较，超出int范围的下标不会截断成合法值
+                lock_guard<mutex> lock(session->lock);
+                int64_t start = body["start"].i();
+                int64_t end = body["end"].i();
+                int numTokens = session->parser.numTokens();
+                if (start < 0 || end < start || end > numTokens) {
+                    return crow::response(400, "Edit range [" + to_string(start) + ", " + to_string(end)
+                                                   + ") out of bounds for " + to_string(numTokens) + " tokens");
+                }
+                auto stats = session->parser.edit(static_cast<int>(start), static_cast<int>(end), replacement);
+                crow::response res(session->toJson(stats, body.has("tree") && body["tree"].b()));
                 res.add_header("Content-Type", "application/json");
                 return res;
             }
             catch (const exception& e) {
-                return crow::response(500, string("Error parsing input with SLR(1): ") + e.what());
+                return crow::response(500, string("Error reparsing: ") + e.what());
+            }
+        });
+
+    // API端点：读取会话的语法树（最近一次成功分析的结果）
+    CROW_ROUTE(app, "/api/reparse_sessions/<int>")
+        .methods("GET"_method)
+        ([&reparseSessions](int sessionId) {
+            auto session = reparseSessions.find(sessionId);
+            if (!session) {
+                return crow::response(404, "Reparse session not found or expired");
             }
+            lock_guard<mutex> lock(session->lock);
+            crow::json::wvalue json;
+            json["parser_type"] = session->parserType;
+            json["token_count"] = session->parser.numTokens();
+            json["up_to_date"] = session->parser.upToDate();
+            json["tree"] = session->parser.treeToJson();
+            crow::response res(json);
+            res.add_header("Content-Type", "application/json");
+            return res;
+        });
+
+    // API端点：关闭增量分析会话
+    CROW_ROUTE(app, "/api/reparse_sessions/<int>/close")
+        .methods("POST"_method)
+        ([&reparseSessions](int sessionId) {
+            if (!reparseSessions.close(sessionId)) {
+                return crow::response(404, "Reparse session not found or expired");
+            }
+            return crow::response(200, "Reparse session closed");
         });
 
     // API端点：测试接口（为主页提供）
@@ -1083,4 +4836,5 @@ int main() {
     app.port(8080).multithreaded().run();
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
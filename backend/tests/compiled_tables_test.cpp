@@ -0,0 +1,187 @@
+// 编译格式：saveCompiled写出的文件经TableView映射后与原分析表逐项一致；损坏或截断的文件在打开时被拒绝
+#include "test_util.h"
+
+static string tempPath(const string& name) {
+    return (filesystem::temp_directory_path() / ("compiled_tables_test_" + to_string(getpid()) + "_" + name)).string();
+}
+
+static vector<char> readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    return vector<char>(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static void writeFile(const string& path, const vector<char>& bytes) {
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+}
+
+template <typename T>
+static T& at(vector<char>& bytes, uint64_t offset) {
+    return *reinterpret_cast<T*>(bytes.data() + offset);
+}
+
+// 保存后映射，逐项比较分析表，并在随机输入上比较识别结果
+static void checkRoundTrip(const ParserBase& parser, bool withItemSets, mt19937& rng) {
+    string path = tempPath("roundtrip.lrt");
+    parser.saveCompiled(path, withItemSets);
+    shared_ptr<const TableView> view = TableView::open(path);
+    const Grammar& grammar = *parser.grammar;
+    int numStates = static_cast<int>(parser.automaton->itemSets.size());
+
+    CHECK_EQ(view->kindName(), parser.kindName());
+    CHECK_EQ(view->numStates(), numStates);
+    CHECK_EQ(view->hasItemSets(), withItemSets);
+    CHECK_EQ(view->endMarkerId(), parser.endMarkerId());
+    for (int id = 0; id < grammar.symbols.size(); id++) {
+        CHECK(view->symbolName(id) == grammar.symbols.name(id));
+    }
+    for (int t = 0; t < grammar.symbols.numTerminals; t++) {
+        CHECK_EQ(view->terminalId(grammar.symbols.name(t)), t);
+    }
+    CHECK_EQ(view->terminalId("no-such-terminal"), -1);
+    for (int p = 0; p < static_cast<int>(grammar.productions.size()); p++) {
+        CHECK_EQ(view->productionLength(p), parser.productionLength(p));
+        CHECK_EQ(view->productionLeft(p), parser.productionLeft(p));
+    }
+    for (int state = 0; state < numStates; state++) {
+        for (int t = 0; t < grammar.symbols.numTerminals; t++) {
+            CHECK_EQ(view->action(state, t), parser.action(state, t));
+        }
+        for (int nt = grammar.symbols.numTerminals; nt < grammar.symbols.size(); nt++) {
+            CHECK_EQ(view->gotoState(state, nt), parser.gotoState(state, nt));
+        }
+    }
+
+    for (int k = 0; k < 50; k++) {
+        string input = randomSentence(grammar, rng, 8);
+        ParserBase::RecognizeResult direct = parser.recognize(input);
+        ParserBase::RecognizeResult mapped = ParserBase::recognizeWith(*view, input);
+        CHECK_EQ(mapped.accepted, direct.accepted);
+        CHECK_EQ(mapped.errorPosition, direct.errorPosition);
+        CHECK_EQ(mapped.steps, direct.steps);
+    }
+    view.reset();
+    filesystem::remove(path);
+}
+
+// 对正确的文件做一处修改后写出，打开时应抛出runtime_error
+static void checkRejected(const vector<char>& good, const function<void(vector<char>&)>& corrupt, const char* what) {
+    vector<char> bytes = good;
+    corrupt(bytes);
+    string path = tempPath("corrupt.lrt");
+    writeFile(path, bytes);
+    bool rejected = false;
+    try {
+        TableView::open(path);
+    }
+    catch (const runtime_error&) {
+        rejected = true;
+    }
+    if (!rejected) {
+        testFailures++;
+        cerr << "corrupted file accepted: " << what << endl;
+    }
+    filesystem::remove(path);
+}
+
+static void checkCorruptedFiles() {
+    // 表达式文法的LALR(1)表，带核心项目
+    LALR1Parser parser;
+    CHECK(buildQuietly(parser, sampleGrammars()[0]));
+    string path = tempPath("good.lrt");
+    parser.saveCompiled(path, true);
+    vector<char> good = readFile(path);
+    filesystem::remove(path);
+
+    CompiledHeader h;
+    memcpy(&h, good.data(), sizeof(h));
+    int numTerminals = h.numTerminals;
+    size_t numActions = static_cast<size_t>(h.numStates) * numTerminals;
+    size_t numGotos = static_cast<size_t>(h.numStates) * (h.numSymbols - h.numTerminals);
+
+    // 找到一个移进表项和一个规约表项的下标
+    size_t shiftCell = numActions, reduceCell = numActions;
+    for (size_t i = 0; i < numActions; i++) {
+        uint32_t act;
+        memcpy(&act, good.data() + h.actionAt + 4 * i, sizeof(act));
+        if (actionKind(act) == ACTION_SHIFT && shiftCell == numActions) shiftCell = i;
+        if (actionKind(act) == ACTION_REDUCE && reduceCell == numActions) reduceCell = i;
+    }
+    CHECK(shiftCell < numActions && reduceCell < numActions);
+
+    checkRejected(good, [&](vector<char>& b) { b.resize(b.size() - 8); }, "truncated");
+    checkRejected(good, [&](vector<char>& b) {
+        b.resize(b.size() - 8);
+        at<CompiledHeader>(b, 0).fileSize = b.size();
+    }, "truncated with patched size");
+    checkRejected(good, [&](vector<char>& b) { b[0] = 'X'; }, "bad magic");
+    checkRejected(good, [&](vector<char>& b) {
+        at<uint32_t>(b, h.actionAt + 4 * shiftCell) = makeAction(ACTION_SHIFT, h.numStates);
+    }, "shift target");
+    checkRejected(good, [&](vector<char>& b) {
+        at<uint32_t>(b, h.actionAt + 4 * reduceCell) = makeAction(ACTION_REDUCE, h.numProductions);
+    }, "reduce target");
+    checkRejected(good, [&](vector<char>& b) {
+        at<uint32_t>(b, h.actionAt) = makeAction(ACTION_ACCEPT, 5);
+    }, "accept with target");
+    checkRejected(good, [&](vector<char>& b) {
+        at<int32_t>(b, h.gotoAt + 4 * (numGotos - 1)) = h.numStates;
+    }, "goto target");
+    checkRejected(good, [&](vector<char>& b) {
+        at<int32_t>(b, h.gotoAt) = -7;
+    }, "negative goto");
+    checkRejected(good, [&](vector<char>& b) {
+        at<int32_t>(b, h.prodLeftAt) = 0;
+    }, "terminal as production left side");
+    checkRejected(good, [&](vector<char>& b) {
+        at<int32_t>(b, h.prodRightAt) = h.numSymbols;
+    }, "production symbol");
+    checkRejected(good, [&](vector<char>& b) {
+        // 第一条产生式的结束偏移越过第二条的结束偏移
+        at<uint32_t>(b, h.prodRightOffsetsAt + 4) = at<uint32_t>(b, h.prodRightOffsetsAt + 8) + 1;
+    }, "production offsets");
+    checkRejected(good, [&](vector<char>& b) {
+        at<uint32_t>(b, h.prodRightOffsetsAt + 4 * h.numProductions) = 0x7FFFFFFF;
+    }, "production length");
+    checkRejected(good, [&](vector<char>& b) {
+        at<uint64_t>(b, h.kernelItemsAt) = Item(h.numProductions, 0).key;
+    }, "kernel item production");
+    checkRejected(good, [&](vector<char>& b) {
+        at<uint64_t>(b, h.kernelItemsAt) = Item(0, 100).key;
+    }, "kernel item dot");
+    checkRejected(good, [&](vector<char>& b) {
+        at<CompiledHeader>(b, 0).endMarker = numTerminals;
+    }, "end marker");
+    checkRejected(good, [&](vector<char>& b) {
+        at<CompiledHeader>(b, 0).numSymbols = INT32_MAX;
+    }, "symbol count");
+    checkRejected(good, [&](vector<char>& b) {
+        // 交换前两个终结符名的偏移区间，破坏有序性
+        uint32_t* offsets = &at<uint32_t>(b, h.symbolOffsetsAt);
+        string first(b.data() + h.symbolNamesAt + offsets[0], offsets[1] - offsets[0]);
+        string second(b.data() + h.symbolNamesAt + offsets[1], offsets[2] - offsets[1]);
+        string swapped = second + first;
+        memcpy(b.data() + h.symbolNamesAt + offsets[0], swapped.data(), swapped.size());
+        offsets[1] = offsets[0] + static_cast<uint32_t>(second.size());
+    }, "unsorted terminals");
+
+    // 未修改的副本仍能打开
+    string copyPath = tempPath("copy.lrt");
+    writeFile(copyPath, good);
+    CHECK(TableView::open(copyPath)->numStates() == h.numStates);
+    filesystem::remove(copyPath);
+}
+
+int main() {
+    mt19937 rng(17);
+    for (const auto& lines : sampleGrammars()) {
+        for (const char* kind : PARSER_KINDS) {
+            shared_ptr<ParserBase> parser = createParser(kind);
+            if (!buildQuietly(*parser, lines)) continue;
+            checkRoundTrip(*parser, false, rng);
+            checkRoundTrip(*parser, true, rng);
+        }
+    }
+    checkCorruptedFiles();
+    return testExitCode();
+}
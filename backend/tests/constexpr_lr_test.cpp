@@ -0,0 +1,223 @@
+// 编译期分析表（include/constexpr_lr.h）与运行时 LR0Parser / SLR1Parser 构造的分析表逐项一致，
+// 包括含ε产生式的文法和有冲突的文法（冲突按相同的规则解决）
+#include "test_util.h"
+#include "constexpr_lr.h"
+
+struct Expr {
+    static constexpr std::string_view text = R"(
+NonTerminals: E, T, F
+Terminals: +, *, (, ), id
+StartSymbol: E
+Productions:
+E -> E + T | T
+T -> T * F | F
+F -> ( E ) | id
+)";
+};
+
+// ε产生式：A、B可空
+struct Epsilon {
+    static constexpr std::string_view text = R"(
+NonTerminals: S, A, B
+Terminals: a, b, c
+StartSymbol: S
+Productions:
+S -> A B c | a
+A -> a A | ε
+B -> b B | ε
+)";
+};
+
+// 嵌套的ε：S -> a S b | ε
+struct Balanced {
+    static constexpr std::string_view text = R"(
+NonTerminals: S
+Terminals: a, b
+StartSymbol: S
+Productions:
+S -> a S b | ε
+)";
+};
+
+// 非SLR(1)：'='上的移进-规约冲突
+struct Assign {
+    static constexpr std::string_view text = R"(
+NonTerminals: S, L, R
+Terminals: =, *, id
+StartSymbol: S
+Productions:
+S -> L = R | R
+L -> * R | id
+R -> L
+)";
+};
+
+// 二义文法：SLR(1)中多处移进-规约冲突
+struct Ambiguous {
+    static constexpr std::string_view text = R"(
+NonTerminals: E
+Terminals: +, *, (, ), id
+StartSymbol: E
+Productions:
+E -> E + E | E * E | ( E ) | id
+)";
+};
+
+// 悬空else
+struct DanglingElse {
+    static constexpr std::string_view text = R"(
+NonTerminals: S
+Terminals: i, e, x
+StartSymbol: S
+Productions:
+S -> i S | i S e S | x
+)";
+};
+
+// 规约-规约冲突：LR(0)按规则覆盖，SLR(1)报错
+struct ReduceReduce {
+    static constexpr std::string_view text = R"(
+NonTerminals: S, A, B
+Terminals: a, x
+StartSymbol: S
+Productions:
+S -> A a | B a
+A -> x
+B -> x
+)";
+};
+
+static vector<string> lines(std::string_view text) {
+    vector<string> result;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos) end = text.size();
+        result.emplace_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return result;
+}
+
+// 构造运行时分析表，返回其打印的LR(0)冲突数；构造失败时返回-1
+static int buildRuntime(ParserBase& parser, std::string_view text) {
+    ostringstream captured;
+    streambuf* saved = cout.rdbuf(captured.rdbuf());
+    int conflicts = 0;
+    try {
+        parser.loadGrammar(lines(text));
+        parser.buildParseTable();
+        string line;
+        istringstream printed(captured.str());
+        while (getline(printed, line)) {
+            if (line.find("LR(0) Conflict") != string::npos) conflicts++;
+        }
+    }
+    catch (const runtime_error&) {
+        conflicts = -1;
+    }
+    cout.rdbuf(saved);
+    return conflicts;
+}
+
+template <typename Tables>
+static void checkSameTables(const char* name, const Tables& tables, const ParserBase& parser) {
+    const Grammar& grammar = *parser.grammar;
+    int numStates = static_cast<int>(parser.automaton->itemSets.size());
+    int failuresBefore = testFailures;
+
+    CHECK_EQ(Tables::numStates, numStates);
+    CHECK_EQ(Tables::numTerminals, grammar.symbols.numTerminals);
+    CHECK_EQ(Tables::numNonTerminals, grammar.symbols.numNonTerminals());
+    CHECK_EQ(Tables::numProductions, static_cast<int>(grammar.productions.size()));
+    CHECK_EQ(tables.endMarkerId(), parser.endMarkerId());
+    if (testFailures != failuresBefore) {
+        cerr << "  in " << name << endl;
+        return;
+    }
+
+    for (int t = 0; t < Tables::numTerminals; t++) {
+        CHECK_EQ(tables.terminalId(grammar.symbols.name(t)), t);
+    }
+    for (int p = 0; p < Tables::numProductions; p++) {
+        CHECK_EQ(tables.productionLength(p), parser.productionLength(p));
+        CHECK_EQ(tables.productionLeft(p), parser.productionLeft(p));
+    }
+    for (int state = 0; state < numStates; state++) {
+        for (int t = 0; t < Tables::numTerminals; t++) {
+            CHECK_EQ(tables.action(state, t), parser.action(state, t));
+        }
+        for (int nt = Tables::numTerminals; nt < Tables::numTerminals + Tables::numNonTerminals; nt++) {
+            CHECK_EQ(tables.gotoState(state, nt), parser.gotoState(state, nt));
+        }
+    }
+
+    // 编译期分析表自带的分析循环和 recognizeWith 与运行时分析器的结果相同
+    mt19937 rng(20);
+    for (int k = 0; k < 200; k++) {
+        string input = randomSentence(grammar, rng, 10);
+        ParserBase::RecognizeResult expected = parser.recognize(input);
+        constexpr_lr::Result own = tables.parse(input);
+        ParserBase::RecognizeResult shared = ParserBase::recognizeWith(tables, input);
+        CHECK_EQ(own.accepted, expected.accepted);
+        CHECK_EQ(own.errorPosition, expected.errorPosition);
+        CHECK_EQ(own.steps, expected.steps);
+        CHECK_EQ(shared.accepted, expected.accepted);
+        CHECK_EQ(shared.errorPosition, expected.errorPosition);
+    }
+    if (testFailures != failuresBefore) cerr << "  in " << name << endl;
+}
+
+// LR(0)：任何文法都能构造，冲突数与运行时报告的相同
+template <typename G>
+static void checkLR0(const char* name) {
+    constexpr auto tables = constexpr_lr::lr0Tables<G>();
+    LR0Parser parser;
+    int runtimeConflicts = buildRuntime(parser, G::text);
+    CHECK(runtimeConflicts >= 0);
+    CHECK_EQ(tables.conflicts, runtimeConflicts);
+    checkSameTables(name, tables, parser);
+}
+
+// SLR(1)：无规约-规约冲突的文法
+template <typename G>
+static void checkSLR1(const char* name, bool expectConflicts) {
+    constexpr auto tables = constexpr_lr::slr1Tables<G>();
+    SLR1Parser parser;
+    CHECK(buildRuntime(parser, G::text) >= 0);
+    CHECK_EQ(tables.conflicts > 0, expectConflicts);
+    checkSameTables(name, tables, parser);
+}
+
+int main() {
+    checkLR0<Expr>("Expr");
+    checkLR0<Epsilon>("Epsilon");
+    checkLR0<Balanced>("Balanced");
+    checkLR0<Assign>("Assign");
+    checkLR0<Ambiguous>("Ambiguous");
+    checkLR0<DanglingElse>("DanglingElse");
+    checkLR0<ReduceReduce>("ReduceReduce");
+
+    checkSLR1<Expr>("Expr", false);
+    checkSLR1<Epsilon>("Epsilon", false);
+    checkSLR1<Balanced>("Balanced", false);
+    checkSLR1<Assign>("Assign", true);
+    checkSLR1<Ambiguous>("Ambiguous", true);
+    checkSLR1<DanglingElse>("DanglingElse", true);
+
+    // 规约-规约冲突：编译期构造在常量求值中抛出（即编译错误），这里在运行时求值以观察同样的报错
+    {
+        SLR1Parser parser;
+        CHECK_EQ(buildRuntime(parser, ReduceReduce::text), -1);
+        auto grammar = constexpr_lr::grammar<ReduceReduce>();
+        auto automaton = constexpr_lr::lr0Automaton<ReduceReduce>();
+        CHECK_THROWS(constexpr_lr::detail::buildTables(grammar, automaton, true), std::logic_error);
+    }
+
+    // 编译期求值的结果可直接用于静态断言
+    constexpr auto exprTables = constexpr_lr::slr1Tables<Expr>();
+    static_assert(exprTables.conflicts == 0, "expression grammar is SLR(1)");
+    static_assert(exprTables.terminalId("id") >= 0 && exprTables.terminalId("nope") == -1, "terminal lookup");
+    static_assert(constexpr_lr::lr0Tables<Expr>().conflicts > 0, "expression grammar is not LR(0)");
+    return testExitCode();
+}
@@ -0,0 +1,298 @@
+// GLR分析：识别结果与穷举的识别器一致；分析森林结构正确；确定性模式与纯GSS分析得到相同的结果和森林
+// 覆盖二义文法、含ε的循环文法、隐式左递归文法和随机文法
+#include "test_util.h"
+
+#include <tuple>
+
+// 穷举识别：derives[A][i][j] 表示符号A能推导出输入区间 [i, j)，反复应用产生式直到不动点（可处理ε和循环）
+static bool bruteForceAccepts(const Grammar& grammar, const vector<int>& tokens) {
+    int n = static_cast<int>(tokens.size());
+    for (int t : tokens) {
+        if (t < 0) return false;
+    }
+    int numSymbols = grammar.symbols.size();
+    vector<vector<vector<char>>> derives(numSymbols, vector<vector<char>>(n + 1, vector<char>(n + 1, 0)));
+    for (int i = 0; i < n; i++) derives[tokens[i]][i][i + 1] = 1;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const Production& prod : grammar.productions) {
+            for (int i = 0; i <= n; i++) {
+                // 依次匹配右部各符号，reach为匹配完前缀后可能到达的位置
+                vector<char> reach(n + 1, 0);
+                reach[i] = 1;
+                for (int symbol : prod.right) {
+                    vector<char> next(n + 1, 0);
+                    for (int j = i; j <= n; j++) {
+                        if (!reach[j]) continue;
+                        for (int k = j; k <= n; k++) {
+                            if (derives[symbol][j][k]) next[k] = 1;
+                        }
+                    }
+                    reach = next;
+                }
+                for (int j = i; j <= n; j++) {
+                    if (reach[j] && !derives[prod.left][i][j]) {
+                        derives[prod.left][i][j] = 1;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return derives[grammar.startSymbol][0][n] != 0;
+}
+
+static vector<int> tokenIds(const Grammar& grammar, const string& input) {
+    vector<int> ids;
+    for (const auto& name : Grammar::split(input, ' ')) {
+        int id = grammar.symbols.find(name);
+        ids.push_back(id >= 0 && grammar.symbols.isTerminal(id) ? id : -1);
+    }
+    return ids;
+}
+
+using Span = tuple<int, int, int>;   // (符号, 起点, 终点)，同一次分析中唯一确定一个森林结点
+
+// 森林的规范形式：从根可达的每个结点 -> 其全部推导（产生式和子结点），与结点的编号顺序无关
+using CanonicalForest = map<Span, set<pair<int, vector<Span>>>>;
+
+static CanonicalForest canonical(const GLRParser::Forest& forest) {
+    CanonicalForest result;
+    if (forest.root < 0) return result;
+    auto spanOf = [&](int node) {
+        const auto& n = forest.nodes[node];
+        return Span(n.symbol, n.start, n.end);
+    };
+    vector<char> seen(forest.nodes.size(), 0);
+    vector<int> stack = { forest.root };
+    seen[forest.root] = 1;
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        auto& alternatives = result[spanOf(node)];
+        for (int p = forest.nodes[node].firstPacked; p >= 0; p = forest.packed[p].next) {
+            const auto& packed = forest.packed[p];
+            vector<Span> kids;
+            for (int c = 0; c < packed.numChildren; c++) {
+                int child = forest.children[packed.firstChild + c];
+                kids.push_back(spanOf(child));
+                if (!seen[child]) {
+                    seen[child] = 1;
+                    stack.push_back(child);
+                }
+            }
+            alternatives.insert({ packed.production, kids });
+        }
+    }
+    return result;
+}
+
+// 森林结构：每种推导的产生式左部是结点的符号，子结点依次为右部符号且区间首尾相接；叶结点是对应的输入符号
+static void checkForestShape(const Grammar& grammar, const CanonicalForest& forest, const vector<int>& tokens) {
+    for (const auto& [span, alternatives] : forest) {
+        auto [symbol, start, end] = span;
+        CHECK(start <= end);
+        if (grammar.symbols.isTerminal(symbol)) {
+            CHECK(alternatives.empty());
+            CHECK_EQ(end, start + 1);
+            CHECK(start < static_cast<int>(tokens.size()) && tokens[start] == symbol);
+            continue;
+        }
+        CHECK(!alternatives.empty());
+        for (const auto& [production, kids] : alternatives) {
+            const Production& prod = grammar.productions[production];
+            CHECK_EQ(prod.left, symbol);
+            CHECK_EQ(kids.size(), prod.right.size());
+            if (kids.size() != prod.right.size()) continue;
+            int position = start;
+            for (size_t k = 0; k < kids.size(); k++) {
+                CHECK_EQ(get<0>(kids[k]), prod.right[k]);
+                CHECK_EQ(get<1>(kids[k]), position);
+                position = get<2>(kids[k]);
+            }
+            CHECK_EQ(position, end);
+        }
+    }
+}
+
+// 森林中的分析树数目，存在循环（无穷多棵）时返回-1
+static long long countTrees(const CanonicalForest& forest, const Span& span, map<Span, long long>& memo, set<Span>& active) {
+    auto it = memo.find(span);
+    if (it != memo.end()) return it->second;
+    const auto& alternatives = forest.at(span);
+    if (alternatives.empty()) return memo[span] = 1;
+    if (!active.insert(span).second) return -1;
+    long long total = 0;
+    for (const auto& [production, kids] : alternatives) {
+        long long product = 1;
+        for (const Span& kid : kids) {
+            long long count = countTrees(forest, kid, memo, active);
+            if (count < 0) {
+                active.erase(span);
+                return -1;
+            }
+            product *= count;
+        }
+        total += product;
+    }
+    active.erase(span);
+    return memo[span] = total;
+}
+
+static long long countTrees(const GLRParser::Forest& forest) {
+    CanonicalForest canonicalForest = canonical(forest);
+    if (forest.root < 0) return 0;
+    const auto& root = forest.nodes[forest.root];
+    map<Span, long long> memo;
+    set<Span> active;
+    return countTrees(canonicalForest, Span(root.symbol, root.start, root.end), memo, active);
+}
+
+// 对一个输入比较：确定性模式与纯GSS模式、仅识别与建森林、穷举识别器，并检查森林结构
+static void checkInput(const GLRParser& parser, const string& input, const char* what) {
+    const Grammar& grammar = *parser.grammar;
+    vector<int> tokens = tokenIds(grammar, input);
+    bool expected = bruteForceAccepts(grammar, tokens);
+    int failuresBefore = testFailures;
+
+    GLRParser::GLRResult fast = parser.glrParse(input, true, true);
+    GLRParser::GLRResult gss = parser.glrParse(input, true, false);
+    GLRParser::GLRResult recognizeOnly = parser.glrParse(input, false, true);
+
+    CHECK_EQ(fast.accepted, expected);
+    CHECK_EQ(gss.accepted, expected);
+    CHECK_EQ(recognizeOnly.accepted, expected);
+    CHECK_EQ(fast.errorPosition, gss.errorPosition);
+    CHECK_EQ(recognizeOnly.errorPosition, gss.errorPosition);
+    CHECK_EQ(fast.accepted, fast.forest.root >= 0);
+
+    CanonicalForest fastForest = canonical(fast.forest);
+    CHECK(fastForest == canonical(gss.forest));
+    checkForestShape(grammar, fastForest, tokens);
+    if (fast.accepted) {
+        const auto& root = fast.forest.nodes[fast.forest.root];
+        CHECK_EQ(root.symbol, grammar.startSymbol);
+        CHECK_EQ(root.start, 0);
+        CHECK_EQ(root.end, static_cast<int>(tokens.size()));
+    }
+    if (testFailures != failuresBefore) cerr << "  " << what << " input [" << input << "]" << endl;
+}
+
+static void checkGrammar(const vector<string>& lines, const char* what, int maxLength, mt19937& rng) {
+    GLRParser parser;
+    if (!buildQuietly(parser, lines)) {
+        testFailures++;
+        cerr << "cannot build " << what << endl;
+        return;
+    }
+    checkInput(parser, "", what);
+    for (int k = 0; k < 60; k++) {
+        checkInput(parser, randomSentence(*parser.grammar, rng, maxLength), what);
+    }
+}
+
+static vector<string> grammarLines(const string& nonTerminals, const string& terminals, const vector<string>& productions) {
+    vector<string> lines = { "NonTerminals: " + nonTerminals, "Terminals: " + terminals, "StartSymbol: S", "Productions:" };
+    lines.insert(lines.end(), productions.begin(), productions.end());
+    return lines;
+}
+
+// 随机文法：1~4个非终结符、1~3个终结符，右部长度0~3，允许循环和ε
+static vector<string> randomGrammar(mt19937& rng) {
+    static const char* const nts[] = { "S", "A", "B", "C" };
+    static const char* const ts[] = { "a", "b", "c" };
+    int numNonTerminals = 1 + rng() % 4;
+    int numTerminals = 1 + rng() % 3;
+    string ntList, tList;
+    for (int i = 0; i < numNonTerminals; i++) ntList += string(i ? ", " : "") + nts[i];
+    for (int i = 0; i < numTerminals; i++) tList += string(i ? ", " : "") + ts[i];
+
+    vector<string> productions;
+    for (int i = 0; i < numNonTerminals; i++) {
+        string line = string(nts[i]) + " ->";
+        int alternatives = 1 + rng() % 3;
+        for (int a = 0; a < alternatives; a++) {
+            if (a > 0) line += " |";
+            int length = rng() % 4;
+            if (length == 0) line += " ε";
+            for (int k = 0; k < length; k++) {
+                int symbol = rng() % (numNonTerminals + numTerminals);
+                line += " " + string(symbol < numNonTerminals ? nts[symbol] : ts[symbol - numNonTerminals]);
+            }
+        }
+        productions.push_back(line);
+    }
+    return grammarLines(ntList, tList, productions);
+}
+
+int main() {
+    mt19937 rng(21);
+
+    // 二义文法：E -> E + E 上 n 个操作数的分析树数目是第 n-1 个Catalan数
+    {
+        GLRParser parser;
+        CHECK(buildQuietly(parser, grammarLines("S", "+, id", { "S -> S + S | id" })));
+        CHECK(!parser.conflictActions.empty());
+        const long long catalan[] = { 1, 1, 2, 5, 14, 42, 132, 429 };
+        string input = "id";
+        for (int operands = 1; operands <= 8; operands++) {
+            GLRParser::GLRResult fast = parser.glrParse(input, true, true);
+            GLRParser::GLRResult gss = parser.glrParse(input, true, false);
+            CHECK(fast.accepted && gss.accepted);
+            CHECK_EQ(countTrees(fast.forest), catalan[operands - 1]);
+            CHECK_EQ(countTrees(gss.forest), catalan[operands - 1]);
+            input += " + id";
+        }
+    }
+    checkGrammar(grammarLines("S", "+, *, (, ), id", { "S -> S + S | S * S | ( S ) | id" }), "ambiguous expressions", 9, rng);
+    checkGrammar(grammarLines("S", "a", { "S -> S S | a" }), "ambiguous concatenation", 8, rng);
+    checkGrammar(grammarLines("S", "i, e, x", { "S -> i S | i S e S | x" }), "dangling else", 9, rng);
+
+    // 含ε的循环文法：S =>+ S，分析树有无穷多棵，森林中出现环
+    checkGrammar(grammarLines("S", "a", { "S -> S S | a | ε" }), "epsilon-cyclic S S", 6, rng);
+    checkGrammar(grammarLines("S, A", "a, b", { "S -> S A | a", "A -> ε | b" }), "epsilon-cyclic S A", 7, rng);
+    checkGrammar(grammarLines("S, A, B", "a", { "S -> A | a", "A -> B", "B -> S | ε" }), "unit cycle", 5, rng);
+    {
+        GLRParser parser;
+        CHECK(buildQuietly(parser, grammarLines("S", "a", { "S -> S S | a | ε" })));
+        GLRParser::GLRResult result = parser.glrParse("a a", true, true);
+        CHECK(result.accepted);
+        CHECK_EQ(countTrees(result.forest), -1LL);
+    }
+
+    // 隐式左递归：S -> A S b，A可空（Farshi算法要处理的情形）
+    checkGrammar(grammarLines("S, A", "a, b", { "S -> A S b | a", "A -> ε" }), "hidden left recursion", 8, rng);
+    checkGrammar(grammarLines("S, A, B", "a, b, x", { "S -> A B S b | x", "A -> ε | a", "B -> ε" }), "hidden left recursion 2", 8, rng);
+    checkGrammar(grammarLines("S, A", "a, b", { "S -> A S | b", "A -> ε | a" }), "nullable prefix", 8, rng);
+
+    // 确定性文法上与LALR(1)的识别结果相同（全程走确定性模式）
+    for (const auto& lines : sampleGrammars()) {
+        GLRParser glr;
+        LALR1Parser lalr;
+        if (!buildQuietly(lalr, lines)) continue;
+        CHECK(buildQuietly(glr, lines));
+        CHECK(glr.conflictActions.empty());
+        for (int k = 0; k < 100; k++) {
+            string input = randomSentence(*glr.grammar, rng, 10);
+            ParserBase::RecognizeResult expected = lalr.recognize(input);
+            GLRParser::GLRResult result = glr.glrParse(input, false);
+            CHECK_EQ(result.accepted, expected.accepted);
+            CHECK_EQ(result.errorPosition, expected.errorPosition);
+            CHECK(result.maxFrontier <= 1);
+        }
+    }
+
+    // 随机文法
+    for (int g = 0; g < 300; g++) {
+        vector<string> lines = randomGrammar(rng);
+        GLRParser parser;
+        if (!buildQuietly(parser, lines)) continue;   // 开始符号无产生式等无法构造的文法
+        checkInput(parser, "", "random grammar");
+        for (int k = 0; k < 20; k++) {
+            checkInput(parser, randomSentence(*parser.grammar, rng, 6), "random grammar");
+        }
+    }
+    return testExitCode();
+}
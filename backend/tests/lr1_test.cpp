@@ -0,0 +1,107 @@
+// LR(1)分析器（Pager弱相容性合并）：接受LALR(1)因合并产生规约-规约冲突而拒绝的文法；
+// 在LALR(1)文法上状态数与LALR(1)相同、识别结果相同；规范LR(1)比合并后大时合并统计不为0
+#include "test_util.h"
+
+// LR(1)但非LALR(1)：LALR合并 [A -> c·] 和 [B -> c·] 所在的两个状态后向前看集合都是 {d, e}
+static const vector<string> NOT_LALR = {
+    "NonTerminals: S, A, B", "Terminals: a, b, c, d, e", "StartSymbol: S", "Productions:",
+    "S -> a A d | b B d | a B e | b A e", "A -> c", "B -> c",
+};
+
+// 规范LR(1)自动机的状态数：核心和向前看集合都相同才是同一状态（用于核对合并统计）
+static int canonicalLR1States(const ParserBase& parser) {
+    const Grammar& grammar = *parser.grammar;
+    BitSet start(grammar.symbols.numTerminals);
+    start.set(grammar.endMarker);
+    vector<pair<ItemSet, vector<BitSet>>> states = { { { Item(grammar.augmentedProductionIndex, 0) }, { start } } };
+    map<pair<ItemSet, vector<vector<uint64_t>>>, int> index;
+    auto key = [](const ItemSet& kernel, const vector<BitSet>& las) {
+        vector<vector<uint64_t>> words;
+        for (const auto& la : las) words.push_back(la.words);
+        return make_pair(kernel, words);
+    };
+    index[key(states[0].first, states[0].second)] = 0;
+
+    ItemSet items;
+    vector<BitSet> las;
+    for (size_t k = 0; k < states.size(); k++) {
+        parser.lr1Closure(states[k].first, states[k].second, items, las);
+        for (auto& successor : parser.lr1SuccessorKernels(items, las)) {
+            auto successorKey = key(successor.kernel, successor.lookaheads);
+            if (index.count(successorKey)) continue;
+            index[successorKey] = static_cast<int>(states.size());
+            states.push_back({ move(successor.kernel), move(successor.lookaheads) });
+        }
+    }
+    return static_cast<int>(states.size());
+}
+
+int main() {
+    // 经典的LR(1)非LALR(1)文法：LALR(1)报规约-规约冲突，LR(1)构造成功并识别全部四个句子
+    {
+        LALR1Parser lalr;
+        bool threw = false;
+        {
+            QuietCout quiet;
+            lalr.loadGrammar(NOT_LALR);
+            try {
+                lalr.buildParseTable();
+            }
+            catch (const runtime_error& e) {
+                threw = string(e.what()).find("Reduce-reduce conflict") != string::npos;
+            }
+        }
+        CHECK(threw);
+
+        LR1Parser lr1;
+        CHECK(buildQuietly(lr1, NOT_LALR));
+        for (const char* sentence : { "a c d", "b c d", "a c e", "b c e" }) {
+            CHECK(lr1.recognize(sentence).accepted);
+        }
+        for (const char* sentence : { "a c", "a d", "c d", "a c d e", "" }) {
+            CHECK(!lr1.recognize(sentence).accepted);
+        }
+
+        // 两个c后的状态不能合并：比LALR(1)多一个状态；规范LR(1)与之相同，没有合并
+        CHECK_EQ(static_cast<int>(lr1.automaton->itemSets.size()), static_cast<int>(lalr.automaton->itemSets.size()) + 1);
+        CHECK_EQ(lr1.lr1StatesMerged, 0);
+        CHECK_EQ(lr1.lr1ItemSetsBuilt, canonicalLR1States(lr1));
+    }
+
+    // LALR(1)文法：LR(1)的状态数与LALR(1)相同，识别结果相同；
+    // 规范LR(1)的状态比合并后的多，当且仅当构造中发生了合并
+    mt19937 rng(9);
+    int grammarsWithMerges = 0;
+    for (const auto& lines : sampleGrammars()) {
+        LALR1Parser lalr;
+        LR1Parser lr1;
+        CHECK(buildQuietly(lalr, lines));
+        CHECK(buildQuietly(lr1, lines));
+        if (testFailures > 0) break;
+
+        int states = static_cast<int>(lr1.automaton->itemSets.size());
+        int canonical = canonicalLR1States(lr1);
+        int failuresBefore = testFailures;
+        CHECK_EQ(states, static_cast<int>(lalr.automaton->itemSets.size()));
+        CHECK(lr1.lr1ItemSetsBuilt >= states);
+        CHECK_EQ(lr1.lr1StatesMerged > 0, canonical > states);
+        if (canonical > states) grammarsWithMerges++;
+
+        for (int k = 0; k < 300; k++) {
+            string input;
+            if (k % 2 == 0) {
+                for (const auto& token : randomValid(*lr1.grammar, rng)) input += (input.empty() ? "" : " ") + token;
+            } else {
+                input = randomSentence(*lr1.grammar, rng, 10);
+            }
+            ParserBase::RecognizeResult expected = lalr.recognize(input);
+            ParserBase::RecognizeResult actual = lr1.recognize(input);
+            CHECK_EQ(actual.accepted, expected.accepted);
+            CHECK_EQ(actual.errorPosition, expected.errorPosition);
+        }
+        if (testFailures != failuresBefore) cerr << "  in grammar starting with [" << lines[0] << "]" << endl;
+    }
+    // 样例文法中确有规范LR(1)比LALR(1)大的，合并统计在这些文法上不为0
+    CHECK(grammarsWithMerges > 0);
+    return testExitCode();
+}
@@ -0,0 +1,100 @@
+// 语法树输出：由扁平后序数组（toJson(ParseTree)的内容）用一个栈还原整棵树，
+// 每个结点的子结点数、符号和覆盖区间与产生式和输入一致，后序的产生式序列等于reductions()的规约序列
+#include "test_util.h"
+
+// 还原flat表示的树并逐项检查；tokenIds为输入符号的终结符ID
+static void checkFlatTree(const ParserBase& parser, const vector<int>& flat, const vector<int>& tokenIds,
+                          const vector<int>& expectedReductions) {
+    const int fields = ParserBase::TREE_NODE_FIELDS;
+    const int numTokens = static_cast<int>(tokenIds.size());
+    CHECK_EQ(flat.size() % fields, size_t(0));
+
+    struct Subtree {
+        int symbol;
+        int start;
+        int end;
+    };
+    vector<Subtree> stack;
+    vector<int> reductions;
+    int nextToken = 0;
+    for (size_t i = 0; i + fields <= flat.size(); i += fields) {
+        int production = flat[i], childCount = flat[i + 1], start = flat[i + 2], end = flat[i + 3];
+        if (production < 0) {
+            // 终结符叶子：按输入顺序出现，各覆盖一个符号
+            CHECK_EQ(childCount, 0);
+            CHECK_EQ(start, nextToken);
+            CHECK_EQ(end, start + 1);
+            if (start < 0 || start >= numTokens) return;
+            stack.push_back({ tokenIds[start], start, end });
+            nextToken++;
+            continue;
+        }
+
+        // 内部结点：栈顶childCount棵子树依次为产生式右部，区间首尾相接并恰好覆盖父结点
+        reductions.push_back(production);
+        CHECK_EQ(childCount, parser.productionLength(production));
+        if (childCount > static_cast<int>(stack.size())) {
+            CHECK(childCount <= static_cast<int>(stack.size()));
+            return;
+        }
+        const vector<int>& right = parser.grammar->productions[production].right;
+        int position = start;
+        for (int c = 0; c < childCount; c++) {
+            const Subtree& child = stack[stack.size() - childCount + c];
+            CHECK_EQ(child.symbol, right[c]);
+            CHECK_EQ(child.start, position);
+            position = child.end;
+        }
+        CHECK_EQ(position, end);
+        stack.resize(stack.size() - childCount);
+        stack.push_back({ parser.productionLeft(production), start, end });
+    }
+
+    // 剩下唯一的根：开始符号，覆盖整个输入
+    CHECK_EQ(nextToken, numTokens);
+    CHECK_EQ(stack.size(), size_t(1));
+    if (stack.size() == 1) {
+        CHECK_EQ(stack[0].symbol, parser.grammar->startSymbol);
+        CHECK_EQ(stack[0].start, 0);
+        CHECK_EQ(stack[0].end, numTokens);
+    }
+    CHECK(reductions == expectedReductions);
+}
+
+int main() {
+    mt19937 rng(24);
+    for (const auto& lines : sampleGrammars()) {
+        for (const char* kind : { "lr0", "slr1", "lalr1", "lr1" }) {
+            shared_ptr<ParserBase> parser = createParser(kind);
+            if (!buildQuietly(*parser, lines)) continue;
+
+            int accepted = 0;
+            for (int k = 0; k < 400; k++) {
+                // 一半是由文法推导的句子，一半是随机符号串（多半不被接受）
+                string input;
+                if (k % 2 == 0) {
+                    for (const auto& token : randomValid(*parser->grammar, rng)) input += (input.empty() ? "" : " ") + token;
+                } else {
+                    input = randomSentence(*parser->grammar, rng, 10);
+                }
+                ParserBase::ParseTrace trace;
+                bool ok = parser->parse(input, trace);
+                vector<int> flat = ParserBase::flatTree(trace.tree);
+                vector<int> sequence;
+                CHECK_EQ(parser->reductions(input, sequence).accepted, ok);
+                int failuresBefore = testFailures;
+                if (ok) {
+                    accepted++;
+                    checkFlatTree(*parser, flat, trace.tokenIds, sequence);
+                } else {
+                    // 未接受时不输出语法树
+                    CHECK(flat.empty());
+                }
+                if (testFailures != failuresBefore) cerr << "  " << kind << " input [" << input << "]" << endl;
+            }
+            // 随机输入中须有被接受的，否则上面没有检查到任何语法树
+            CHECK(accepted > 0);
+        }
+    }
+    return testExitCode();
+}
@@ -0,0 +1,147 @@
+// 推送式分析：同一输入按任意方式分块送入（含空块、符号跨块）与一次性分析的结果相同，
+// 内存中的分析表和映射的编译文件上都成立；不送入任何内容直接finish()等于分析空输入
+#include "test_util.h"
+
+// 参照结果：由parse()的操作日志得到，不经过PushParser
+static ParserBase::RecognizeResult traced(const ParserBase& parser, const string& input) {
+    ParserBase::ParseTrace trace;
+    ParserBase::RecognizeResult result;
+    result.accepted = parser.parse(input, trace);
+    result.steps = static_cast<int>(trace.ops.size());
+    if (!result.accepted) result.errorPosition = trace.ops.back().inputPos;
+    return result;
+}
+
+static bool sameResult(const ParserBase::RecognizeResult& a, const ParserBase::RecognizeResult& b) {
+    return a.accepted == b.accepted && a.errorPosition == b.errorPosition && a.steps == b.steps;
+}
+
+// 随机输入：文法中的符号和未知符号，以一个或多个空格、制表符分隔
+static string randomText(const Grammar& grammar, mt19937& rng) {
+    static const char* const separators[] = { " ", " ", " ", "  ", " \t", "\t ", " \t ", "\t\t " };
+    string text = rng() % 4 == 0 ? " " : "";
+    int length = static_cast<int>(rng() % 12);
+    for (int i = 0; i < length; i++) {
+        if (i > 0) text += separators[rng() % size(separators)];
+        if (rng() % 25 == 0) {
+            text += "unknown";
+            continue;
+        }
+        int terminal;
+        do {
+            terminal = static_cast<int>(rng() % grammar.symbols.numTerminals);
+        } while (terminal == grammar.endMarker);
+        text += grammar.symbols.name(terminal);
+    }
+    if (rng() % 4 == 0) text += " ";
+    return text;
+}
+
+// 把text切成若干块，maxChunk为块长上限，含长度为0的块
+static vector<string> randomChunks(const string& text, mt19937& rng, size_t maxChunk) {
+    vector<string> chunks;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t length = rng() % (maxChunk + 1);
+        chunks.push_back(text.substr(pos, length));
+        pos += length;
+    }
+    if (rng() % 2) chunks.push_back("");
+    return chunks;
+}
+
+template <typename Tables>
+static void checkChunking(const Tables& tables, const string& text, const ParserBase::RecognizeResult& expected, mt19937& rng) {
+    int failuresBefore = testFailures;
+
+    // 一次送入
+    CHECK(sameResult(ParserBase::recognizeWith(tables, text), expected));
+
+    // 逐字节、固定块长和随机块长（含空块）
+    for (size_t chunkSize : { size_t(1), size_t(2), size_t(3), size_t(7) }) {
+        PushParser<Tables> parser(tables);
+        for (size_t pos = 0; pos < text.size(); pos += chunkSize) parser.feedText(text.substr(pos, chunkSize));
+        CHECK(sameResult(parser.finish(), expected));
+    }
+    for (size_t maxChunk : { size_t(1), size_t(4), size_t(16) }) {
+        PushParser<Tables> parser(tables);
+        parser.feedText("");
+        for (const string& chunk : randomChunks(text, rng, maxChunk)) parser.feedText(chunk);
+        CHECK(sameResult(parser.finish(), expected));
+        CHECK(parser.finished());
+        // finish()可以重复调用，结束后再送入不改变结果
+        CHECK(!parser.feedText("id "));
+        CHECK(sameResult(parser.finish(), expected));
+    }
+
+    // 按符号送入（切分规则与parse()相同）
+    {
+        PushParser<Tables> parser(tables);
+        parser.feed(Grammar::split(text, ' '));
+        CHECK(sameResult(parser.finish(), expected));
+    }
+
+    // 分块送入到一半时复制分析器（检查点），两份各自继续，结果都与一次送入相同
+    {
+        PushParser<Tables> parser(tables);
+        size_t half = text.size() / 2;
+        parser.feedText(text.substr(0, half));
+        PushParser<Tables> checkpoint = parser;
+        parser.feedText(text.substr(half));
+        CHECK(sameResult(parser.finish(), expected));
+        for (char c : text.substr(half)) checkpoint.feedText(string(1, c));
+        CHECK(sameResult(checkpoint.finish(), expected));
+    }
+    if (testFailures != failuresBefore) cerr << "  input [" << text << "]" << endl;
+}
+
+template <typename Tables>
+static void checkEmptyFeeds(const Tables& tables, const ParserBase::RecognizeResult& emptyInput) {
+    // 不送入任何内容直接finish()
+    {
+        PushParser<Tables> parser(tables);
+        CHECK(!parser.finished());
+        CHECK_EQ(parser.tokensConsumed(), 0);
+        CHECK(sameResult(parser.finish(), emptyInput));
+        CHECK(parser.finished());
+    }
+    // 只送入空块和空白
+    {
+        PushParser<Tables> parser(tables);
+        CHECK(parser.feedText(""));
+        CHECK(parser.feedText(" "));
+        CHECK(parser.feedText("\t"));
+        CHECK(parser.feedText(""));
+        CHECK(parser.feed(vector<string>()));
+        CHECK_EQ(parser.tokensConsumed(), 0);
+        CHECK(sameResult(parser.finish(), emptyInput));
+    }
+}
+
+int main() {
+    mt19937 rng(22);
+    string path = (filesystem::temp_directory_path() / ("push_parser_test_" + to_string(getpid()) + ".lrt")).string();
+
+    for (const auto& lines : sampleGrammars()) {
+        for (const char* kind : { "slr1", "lalr1", "lr1" }) {
+            shared_ptr<ParserBase> parser = createParser(kind);
+            if (!buildQuietly(*parser, lines)) continue;
+            parser->saveCompiled(path, false);
+            shared_ptr<const TableView> view = TableView::open(path);
+
+            ParserBase::RecognizeResult emptyInput = traced(*parser, "");
+            checkEmptyFeeds(*parser, emptyInput);
+            checkEmptyFeeds(*view, emptyInput);
+
+            for (int k = 0; k < 60; k++) {
+                string text = randomText(*parser->grammar, rng);
+                ParserBase::RecognizeResult expected = traced(*parser, text);
+                CHECK(sameResult(parser->recognize(text), expected));
+                checkChunking(*parser, text, expected, rng);
+                checkChunking(*view, text, expected, rng);
+            }
+        }
+    }
+    filesystem::remove(path);
+    return testExitCode();
+}
@@ -0,0 +1,125 @@
+// 规约序列输出：reductions()得到的整数序列、以及按小端int32打包后Base64编码的序列，
+// 解码后都与完整分析轨迹（parse()的操作日志）中的规约产生式ID相同；
+// Base64的填充路径（字节数除以3余0、1、2，含空序列）按RFC 4648的测试向量检查
+#include "test_util.h"
+
+// 独立的Base64解码，不复用被测的编码实现；格式错误时返回false
+static bool base64Decode(const string& text, string& bytes) {
+    static const string ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    bytes.clear();
+    if (text.size() % 4 != 0) return false;
+    for (size_t i = 0; i < text.size(); i += 4) {
+        uint32_t chunk = 0;
+        int padding = 0;
+        for (int k = 0; k < 4; k++) {
+            char c = text[i + k];
+            if (c == '=') {
+                // 填充只能出现在最后一组的末尾一两个字符
+                if (i + 4 != text.size() || k < 2) return false;
+                padding++;
+                chunk <<= 6;
+                continue;
+            }
+            size_t value = ALPHABET.find(c);
+            if (value == string::npos || padding > 0) return false;
+            chunk = (chunk << 6) | static_cast<uint32_t>(value);
+        }
+        bytes += static_cast<char>((chunk >> 16) & 0xff);
+        if (padding < 2) bytes += static_cast<char>((chunk >> 8) & 0xff);
+        if (padding < 1) bytes += static_cast<char>(chunk & 0xff);
+    }
+    return true;
+}
+
+// 小端int32解包；字节数不是4的倍数时返回false
+static bool unpackInt32(const string& bytes, vector<int>& values) {
+    values.clear();
+    if (bytes.size() % 4 != 0) return false;
+    for (size_t i = 0; i < bytes.size(); i += 4) {
+        uint32_t value = 0;
+        for (int b = 0; b < 4; b++) value |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[i + b])) << (8 * b);
+        values.push_back(static_cast<int>(value));
+    }
+    return true;
+}
+
+// reductions_base64 的内容解码回整数序列
+static vector<int> decodeReductions(const vector<int>& sequence) {
+    string encoded = base64Encode(ParserBase::packInt32(sequence));
+    CHECK_EQ(encoded.size() % 4, size_t(0));
+    string bytes;
+    vector<int> values;
+    CHECK(base64Decode(encoded, bytes));
+    CHECK(unpackInt32(bytes, values));
+    return values;
+}
+
+// 完整轨迹中的规约：操作日志里每条规约操作的产生式ID（规约后GOTO失败的那一步也算）
+static vector<int> tracedReductions(const ParserBase& parser, const string& input, bool& accepted) {
+    ParserBase::ParseTrace trace;
+    accepted = parser.parse(input, trace);
+    vector<int> sequence;
+    for (const auto& op : trace.ops) {
+        if (actionKind(op.action) == ACTION_REDUCE) sequence.push_back(static_cast<int>(actionTarget(op.action)));
+    }
+    return sequence;
+}
+
+int main() {
+    // Base64编码：RFC 4648的测试向量覆盖空输入和三种余数
+    const pair<string, string> vectors[] = {
+        { "", "" }, { "f", "Zg==" }, { "fo", "Zm8=" }, { "foo", "Zm9v" },
+        { "foob", "Zm9vYg==" }, { "fooba", "Zm9vYmE=" }, { "foobar", "Zm9vYmFy" },
+        { string("\xff\x00\x80", 3), "/wCA" }, { string("\xfb\xff", 2), "+/8=" },
+    };
+    for (const auto& [bytes, encoded] : vectors) {
+        CHECK_EQ(base64Encode(bytes), encoded);
+        string decoded;
+        CHECK(base64Decode(encoded, decoded));
+        CHECK(decoded == bytes);
+    }
+
+    // 打包后的序列：0、1、2、3个整数分别是0、4、8、12字节，Base64的三种填充情形都会出现；
+    // 含负数和高字节大于0x7f的值，检查符号和字节序
+    const vector<vector<int>> sequences = {
+        {}, { 7 }, { 0, -1 }, { 1, 256, 65536 }, { INT_MIN, INT_MAX, 0x7f80ff01, -2 },
+    };
+    for (const auto& sequence : sequences) {
+        CHECK_EQ(ParserBase::packInt32(sequence).size(), sequence.size() * 4);
+        CHECK(decodeReductions(sequence) == sequence);
+    }
+    CHECK_EQ(base64Encode(ParserBase::packInt32({})), string());
+    CHECK_EQ(base64Encode(ParserBase::packInt32({ 1 })), string("AQAAAA=="));
+    CHECK_EQ(base64Encode(ParserBase::packInt32({ 1, 2 })), string("AQAAAAIAAAA="));
+
+    // 各分析器、随机输入（含被拒绝的和空输入）：两种输出解码后与完整轨迹的规约相同
+    mt19937 rng(25);
+    for (const auto& lines : sampleGrammars()) {
+        for (const char* kind : { "lr0", "slr1", "lalr1", "lr1" }) {
+            shared_ptr<ParserBase> parser = createParser(kind);
+            if (!buildQuietly(*parser, lines)) continue;
+
+            for (int k = 0; k < 300; k++) {
+                string input;
+                if (k == 0) {
+                    input = "";
+                } else if (k % 2 == 0) {
+                    for (const auto& token : randomValid(*parser->grammar, rng)) input += (input.empty() ? "" : " ") + token;
+                } else {
+                    input = randomSentence(*parser->grammar, rng, 10);
+                }
+
+                bool accepted = false;
+                vector<int> expected = tracedReductions(*parser, input, accepted);
+                vector<int> sequence;
+                ParserBase::RecognizeResult result = parser->reductions(input, sequence);
+                int failuresBefore = testFailures;
+                CHECK_EQ(result.accepted, accepted);
+                CHECK(sequence == expected);
+                CHECK(decodeReductions(sequence) == expected);
+                if (testFailures != failuresBefore) cerr << "  " << kind << " input [" << input << "]" << endl;
+            }
+        }
+    }
+    return testExitCode();
+}
@@ -0,0 +1,129 @@
+// 增量分析：随机编辑序列的每一步，IncrementalParser的结果（是否接受、出错位置、语法树）
+// 都与对编辑后的整个输入从头调用parse()的结果相同；越界的编辑抛出异常且不改变会话
+#include "test_util.h"
+
+// 随机符号：多数是文法的终结符，偶尔是未知符号
+static vector<string> randomTokens(const Grammar& grammar, mt19937& rng, int maxLength) {
+    vector<string> tokens;
+    int length = static_cast<int>(rng() % (maxLength + 1));
+    for (int i = 0; i < length; i++) {
+        if (rng() % 20 == 0) {
+            tokens.push_back("unknown");
+            continue;
+        }
+        int terminal;
+        do {
+            terminal = static_cast<int>(rng() % grammar.symbols.numTerminals);
+        } while (terminal == grammar.endMarker);
+        tokens.push_back(grammar.symbols.name(terminal));
+    }
+    return tokens;
+}
+
+static string join(const vector<string>& tokens) {
+    string text;
+    for (const auto& token : tokens) {
+        if (!text.empty()) text += ' ';
+        text += token;
+    }
+    return text;
+}
+
+// parse()语法树的扁平后序表示（结点本来就按后序分配）
+static vector<int> flatten(const ParserBase::ParseTree& tree) {
+    vector<int> flat;
+    if (tree.root < 0) return flat;
+    for (const auto& node : tree.nodes) {
+        flat.insert(flat.end(), { node.production, node.childCount, node.tokenStart, node.tokenEnd });
+    }
+    return flat;
+}
+
+// 整个测试中复用的旧子树数，确认编辑确实走了增量路径
+static long totalReused = 0;
+
+// 在current上做编辑 [start, end) -> replacement，并与从头分析的结果比较
+static void applyAndCheck(const ParserBase& parser, IncrementalParser& incremental, vector<string>& current,
+                          int start, int end, const vector<string>& replacement) {
+    IncrementalParser::Stats stats = incremental.edit(start, end, replacement);
+    totalReused += stats.reusedNodes;
+    current.erase(current.begin() + start, current.begin() + end);
+    current.insert(current.begin() + start, replacement.begin(), replacement.end());
+
+    ParserBase::ParseTrace trace;
+    bool accepted = parser.parse(join(current), trace);
+    int failuresBefore = testFailures;
+    CHECK_EQ(incremental.numTokens(), static_cast<int>(current.size()));
+    CHECK_EQ(stats.accepted, accepted);
+    CHECK_EQ(incremental.upToDate(), accepted);
+    CHECK_EQ(stats.errorPosition, accepted ? -1 : trace.ops.back().inputPos);
+    // 出错时保留原来的语法树，只在接受时比较
+    if (accepted) CHECK(incremental.flatTree() == flatten(trace.tree));
+    if (testFailures != failuresBefore) {
+        cerr << "  edit [" << start << ", " << end << ") -> [" << join(replacement) << "], input [" << join(current) << "]" << endl;
+    }
+}
+
+// 把current改成target：只替换两者公共前缀、后缀之间的部分（最小的单次编辑）
+static void editTo(const ParserBase& parser, IncrementalParser& incremental, vector<string>& current,
+                   const vector<string>& target) {
+    size_t prefix = 0;
+    while (prefix < current.size() && prefix < target.size() && current[prefix] == target[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < current.size() - prefix && suffix < target.size() - prefix
+           && current[current.size() - 1 - suffix] == target[target.size() - 1 - suffix]) {
+        suffix++;
+    }
+    vector<string> replacement(target.begin() + prefix, target.end() - suffix);
+    applyAndCheck(parser, incremental, current, static_cast<int>(prefix), static_cast<int>(current.size() - suffix), replacement);
+}
+
+int main() {
+    mt19937 rng(23);
+    for (const auto& lines : sampleGrammars()) {
+        for (const char* kind : { "slr1", "lalr1", "lr1" }) {
+            shared_ptr<ParserBase> parser = createParser(kind);
+            if (!buildQuietly(*parser, lines)) continue;
+            const Grammar& grammar = *parser->grammar;
+
+            for (int session = 0; session < 10; session++) {
+                IncrementalParser incremental(parser);
+                vector<string> current;
+                applyAndCheck(*parser, incremental, current, 0, 0, randomValid(grammar, rng));
+
+                for (int k = 0; k < 60; k++) {
+                    int n = static_cast<int>(current.size());
+                    switch (rng() % 4) {
+                    case 0:
+                    case 1:
+                        // 改成另一个合法句子：编辑位于中间，两侧的子树可以复用
+                        editTo(*parser, incremental, current, randomValid(grammar, rng));
+                        break;
+                    case 2: {
+                        // 在随机位置插入、删除或替换几个随机符号，结果多半不合法，编辑范围累积到下次
+                        int start = static_cast<int>(rng() % (n + 1));
+                        int end = start + static_cast<int>(rng() % (min(n - start, 3) + 1));
+                        applyAndCheck(*parser, incremental, current, start, end, randomTokens(grammar, rng, 3));
+                        break;
+                    }
+                    default: {
+                        // 越界的编辑被拒绝，会话保持不变
+                        bool upToDate = incremental.upToDate();
+                        CHECK_THROWS(incremental.edit(-1, 0, {}), runtime_error);
+                        CHECK_THROWS(incremental.edit(0, n + 1, {}), runtime_error);
+                        if (n > 0) CHECK_THROWS(incremental.edit(n, n - 1, { "id" }), runtime_error);
+                        CHECK_EQ(incremental.numTokens(), n);
+                        CHECK_EQ(incremental.upToDate(), upToDate);
+                        // 空编辑：不改变输入，但仍然重新分析累积的编辑范围
+                        int position = static_cast<int>(rng() % (n + 1));
+                        applyAndCheck(*parser, incremental, current, position, position, {});
+                        break;
+                    }
+                    }
+                }
+            }
+        }
+    }
+    CHECK(totalReused > 0);
+    return testExitCode();
+}
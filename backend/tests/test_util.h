@@ -0,0 +1,132 @@
+// 测试公用部分：直接编译main.cpp中的分析器（不含服务器入口），提供检查宏和常用文法
+#pragma once
+
+#define BACKEND_NO_MAIN
+#include "../main.cpp"
+
+#include <random>
+
+static int testFailures = 0;
+
+// 检查失败时打印位置并计数，测试继续执行；main返回 testExitCode()
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            testFailures++;                                                             \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #cond << endl;    \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do {                                                                                \
+        auto&& checkA_ = (a);                                                           \
+        auto&& checkB_ = (b);                                                           \
+        if (!(checkA_ == checkB_)) {                                                    \
+            testFailures++;                                                             \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " #a " == " #b   \
+                 << " (" << checkA_ << " vs " << checkB_ << ")" << endl;                \
+        }                                                                               \
+    } while (0)
+
+// 检查表达式抛出指定类型的异常
+#define CHECK_THROWS(expr, type)                                                        \
+    do {                                                                                \
+        bool thrown_ = false;                                                           \
+        try { (void)(expr); } catch (const type&) { thrown_ = true; }                   \
+        if (!thrown_) {                                                                 \
+            testFailures++;                                                             \
+            cerr << __FILE__ << ":" << __LINE__ << ": expected " #type " from " #expr << endl; \
+        }                                                                               \
+    } while (0)
+
+inline int testExitCode() {
+    if (testFailures == 0) {
+        cout << "OK" << endl;
+        return 0;
+    }
+    cout << testFailures << " check(s) failed" << endl;
+    return 1;
+}
+
+// 构造分析器时屏蔽其向cout输出的调试信息
+struct QuietCout {
+    QuietCout() : saved(cout.rdbuf(nullptr)) {}
+    ~QuietCout() {
+        cout.rdbuf(saved);
+        cout.clear();
+    }
+    streambuf* saved;
+};
+
+// 加载文法并构造分析表，冲突等构造失败时返回false
+inline bool buildQuietly(ParserBase& parser, const vector<string>& grammarLines) {
+    QuietCout quiet;
+    try {
+        parser.loadGrammar(grammarLines);
+        parser.buildParseTable();
+        return true;
+    }
+    catch (const exception&) {
+        return false;
+    }
+}
+
+// 常用文法：表达式、含ε产生式、LALR但非SLR、嵌套匹配、右递归列表
+inline vector<vector<string>> sampleGrammars() {
+    return {
+        { "NonTerminals: E, T, F", "Terminals: +, *, (, ), id", "StartSymbol: E", "Productions:",
+          "E -> E + T", "E -> T", "T -> T * F", "T -> F", "F -> ( E )", "F -> id" },
+        { "NonTerminals: S, A, B", "Terminals: a, b, c", "StartSymbol: S", "Productions:",
+          "S -> A B c | a", "A -> a A | ε", "B -> b B | ε" },
+        { "NonTerminals: S, L, R", "Terminals: =, *, id", "StartSymbol: S", "Productions:",
+          "S -> L = R | R", "L -> * R | id", "R -> L" },
+        { "NonTerminals: S", "Terminals: a, b", "StartSymbol: S", "Productions:",
+          "S -> a S b | ε" },
+        { "NonTerminals: P, L, S", "Terminals: id, =, ;", "StartSymbol: P", "Productions:",
+          "P -> L", "L -> S L | S", "S -> id = id ;" },
+    };
+}
+
+// 由文法的终结符（不含#）随机生成长度不超过maxLength的符号串，以空格分隔
+inline string randomSentence(const Grammar& grammar, mt19937& rng, int maxLength) {
+    string text;
+    int length = static_cast<int>(rng() % (maxLength + 1));
+    for (int i = 0; i < length; i++) {
+        int terminal;
+        do {
+            terminal = static_cast<int>(rng() % grammar.symbols.numTerminals);
+        } while (terminal == grammar.endMarker);
+        if (!text.empty()) text += ' ';
+        text += grammar.symbols.name(terminal);
+    }
+    return text;
+}
+
+// 由文法随机推导出一个句子；深度超过maxDepth后只选右部非终结符最少的产生式，保证推导结束
+inline void derive(const Grammar& grammar, int symbol, mt19937& rng, int depth, int maxDepth, vector<string>& out) {
+    if (grammar.symbols.isTerminal(symbol)) {
+        out.push_back(grammar.symbols.name(symbol));
+        return;
+    }
+    const vector<int>& candidates = grammar.productionsByLeft[symbol];
+    int chosen = candidates[rng() % candidates.size()];
+    if (depth >= maxDepth) {
+        int fewest = INT_MAX;
+        for (int p : candidates) {
+            int count = 0;
+            for (int s : grammar.productions[p].right) count += !grammar.symbols.isTerminal(s);
+            if (count < fewest) {
+                fewest = count;
+                chosen = p;
+            }
+        }
+    }
+    for (int s : grammar.productions[chosen].right) derive(grammar, s, rng, depth + 1, maxDepth, out);
+}
+
+// 由文法推导的随机句子（分析表无冲突时总被接受）
+inline vector<string> randomValid(const Grammar& grammar, mt19937& rng) {
+    vector<string> tokens;
+    derive(grammar, grammar.startSymbol, rng, 0, 2 + static_cast<int>(rng() % 6), tokens);
+    return tokens;
+}
@@ -0,0 +1,130 @@
+// 分析轨迹缓存：交替进行的多次带轨迹分析（同一分析器或不同分析器）都能按trace_id分窗口读取；
+// 同一文法上重新构造分析表不影响已有轨迹，换文法只丢弃该分析器旧文法上的轨迹；超出预算时按LRU淘汰
+#include "test_util.h"
+
+static const vector<string> EXPR = sampleGrammars()[0];
+static const vector<string> BALANCED = sampleGrammars()[3];
+
+static bool sameSteps(const vector<ParserBase::ParseStep>& a, const vector<ParserBase::ParseStep>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].step != b[i].step || a[i].stateStack != b[i].stateStack || a[i].symbolStack != b[i].symbolStack
+            || a[i].currentInput != b[i].currentInput || a[i].remainingInput != b[i].remainingInput
+            || a[i].action != b[i].action) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 与 /api/load_grammar 相同：在新分析器上加载文法后发布
+static void loadInto(ParserSlot& slot, const vector<string>& lines) {
+    QuietCout quiet;
+    auto parser = slot.create();
+    parser->loadGrammar(lines);
+    lock_guard<mutex> lock(slot.writeMutex);
+    slot.publish(parser);
+}
+
+// 由id从缓存读取轨迹，按窗口读取全部步骤，与对同一输入重新分析得到的步骤比较
+static void checkReadable(TraceStore& store, int id, const string& input, const ParserBase& reference) {
+    auto traced = store.find(id);
+    CHECK(traced != nullptr);
+    if (!traced) return;
+    ParserBase::ParseTrace fresh;
+    reference.parse(input, fresh);
+    size_t total = fresh.ops.size();
+    CHECK_EQ(traced->trace.ops.size(), total);
+
+    vector<ParserBase::ParseStep> windows;
+    for (size_t from = 0; from < total; from += 7) {
+        auto window = traced->compiled->parseStepsWindow(traced->trace, from, 7);
+        windows.insert(windows.end(), window.begin(), window.end());
+    }
+    CHECK(sameSteps(windows, reference.parseStepsWindow(fresh, 0, total)));
+}
+
+static string repeatedSum(int terms) {
+    string input = "id";
+    for (int i = 1; i < terms; i++) input += " + ( id * id )";
+    return input;
+}
+
+int main() {
+    // 同一分析器上两次交替的分析，以及另一个分析器上的分析，都仍可读取
+    {
+        TraceStore store(64u << 20);
+        ParserSlot slr1("SLR(1)", [] { return make_shared<SLR1Parser>(); }, store);
+        ParserSlot lalr1("LALR(1)", [] { return make_shared<LALR1Parser>(); }, store);
+        loadInto(slr1, EXPR);
+        loadInto(lalr1, EXPR);
+        { QuietCout quiet; slr1.rebuild(); lalr1.rebuild(); }
+
+        string first = repeatedSum(400), second = "id * ( id + id", third = repeatedSum(50);
+        auto a = slr1.parseTraced(first);
+        auto b = slr1.parseTraced(second);
+        auto c = lalr1.parseTraced(third);
+        CHECK(a->trace.id != b->trace.id);
+        CHECK_EQ(store.size(), size_t(3));
+        CHECK(slr1.latestParse() == b);
+
+        // 交替读取
+        checkReadable(store, b->trace.id, second, *slr1.snapshot());
+        checkReadable(store, a->trace.id, first, *slr1.snapshot());
+        checkReadable(store, c->trace.id, third, *lalr1.snapshot());
+        checkReadable(store, a->trace.id, first, *slr1.snapshot());
+
+        // 同一文法上重新构造分析表：已有轨迹连同其快照仍可读取
+        auto before = slr1.snapshot();
+        { QuietCout quiet; slr1.rebuild(); }
+        CHECK(slr1.snapshot() != before);
+        checkReadable(store, a->trace.id, first, *before);
+        checkReadable(store, b->trace.id, second, *before);
+
+        // SLR(1)换文法：只丢弃它在旧文法上的轨迹，LALR(1)的轨迹不受影响（两者的文法对象不同）
+        loadInto(slr1, BALANCED);
+        CHECK(store.find(a->trace.id) == nullptr);
+        CHECK(store.find(b->trace.id) == nullptr);
+        checkReadable(store, c->trace.id, third, *lalr1.snapshot());
+        CHECK_EQ(store.size(), size_t(1));
+        // 已经取得轨迹的请求仍持有它，不受丢弃影响
+        CHECK_EQ(a->trace.tokens.size(), Grammar::split(first, ' ').size());
+
+        // 不存在的id
+        CHECK(store.find(-1) == nullptr);
+    }
+
+    // 字节预算：超出时淘汰最久未读取的轨迹，刚加入的总是保留
+    {
+        SLR1Parser parser;
+        CHECK(buildQuietly(parser, EXPR));
+        ParserBase::ParseTrace probe;
+        parser.parse(repeatedSum(100), probe);
+        size_t oneTrace = probe.memoryUsage();
+
+        TraceStore store(oneTrace * 2 + oneTrace / 2);
+        ParserSlot slot("SLR(1)", [] { return make_shared<SLR1Parser>(); }, store);
+        loadInto(slot, EXPR);
+        { QuietCout quiet; slot.rebuild(); }
+
+        auto a = slot.parseTraced(repeatedSum(100));
+        auto b = slot.parseTraced(repeatedSum(100));
+        CHECK(store.find(a->trace.id) != nullptr);   // a成为最近读取的
+        auto c = slot.parseTraced(repeatedSum(100));
+        CHECK_EQ(store.size(), size_t(2));
+        CHECK(store.find(b->trace.id) == nullptr);   // 最久未读取的b被淘汰
+        CHECK(store.find(a->trace.id) != nullptr);
+        CHECK(store.find(c->trace.id) != nullptr);
+
+        // 单条轨迹超过预算时仍保留最新的一条
+        TraceStore tiny(1);
+        ParserSlot tinySlot("SLR(1)", [] { return make_shared<SLR1Parser>(); }, tiny);
+        loadInto(tinySlot, EXPR);
+        { QuietCout quiet; tinySlot.rebuild(); }
+        tinySlot.parseTraced("id");
+        auto last = tinySlot.parseTraced("id + id");
+        CHECK_EQ(tiny.size(), size_t(1));
+        CHECK(tiny.find(last->trace.id) != nullptr);
+    }
+    return testExitCode();
+}